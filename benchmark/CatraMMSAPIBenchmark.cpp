@@ -0,0 +1,378 @@
+#include "CatraMMSAPI.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <new>
+
+using namespace std;
+using json = nlohmann::json;
+
+// Microbenchmarks of the response parsing (parse*) and of the request building (*URL) against synthetic payloads.
+// For every size it reports ns, allocations and allocated bytes per element, usage:
+//		CatraMMSAPIBenchmark [<max elements, default 100000>]
+
+// every allocation of the process (library included) goes through here
+static atomic<uint64_t> allocationsNumber = 0;
+static atomic<uint64_t> allocatedBytes = 0;
+
+void *operator new(size_t size)
+{
+	allocationsNumber.fetch_add(1, memory_order_relaxed);
+	allocatedBytes.fetch_add(size, memory_order_relaxed);
+
+	if (void *pointer = malloc(size == 0 ? 1 : size))
+		return pointer;
+
+	throw bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *pointer) noexcept { free(pointer); }
+void operator delete[](void *pointer) noexcept { free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { free(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { free(pointer); }
+
+class CatraMMSAPIBenchmark
+{
+  public:
+	explicit CatraMMSAPIBenchmark(json configurationRoot) : _configurationRoot(std::move(configurationRoot)), _api(_configurationRoot)
+	{
+		// the *URL methods only need the base urls of the session
+		_session.apiURL = _api._apiURL;
+		_session.binaryURL = _api._binaryURL;
+	}
+
+	void run(int64_t maxElements)
+	{
+		cout << std::format("{:<36} {:>8} {:>14} {:>14} {:>16}\n", "benchmark", "elements", "ns/element", "allocs/element", "bytes/element");
+
+		{
+			// the login response has always one user and one workspace
+			string body = loginBody();
+			measure(
+				"parseLogin", 1, body,
+				[&]()
+				{
+					CatraMMSAPI::UserProfile userProfile;
+					CatraMMSAPI::WorkspaceDetails workspaceDetails;
+					string mmsVersion;
+					CatraMMSAPI::parseLogin(body, userProfile, workspaceDetails, mmsVersion);
+				}
+			);
+		}
+
+		for (int64_t elements = 1; elements <= maxElements; elements *= 10)
+		{
+			{
+				string body = ingestionWorkflowBody(elements);
+				measure("parseIngestionWorkflow", elements, body, [&]() { CatraMMSAPI::parseIngestionWorkflow(body); });
+			}
+			{
+				string body = encodingProfilesBody(elements);
+				measure("parseEncodingProfiles", elements, body, [&]() { CatraMMSAPI::parseEncodingProfiles(body); });
+				measure(
+					"parseEncodingProfiles+details", elements, body,
+					[&]()
+					{
+						for (const CatraMMSAPI::EncodingProfile &encodingProfile : CatraMMSAPI::parseEncodingProfiles(body))
+						{
+							encodingProfile.videoDetails();
+							encodingProfile.audioDetails();
+						}
+					}
+				);
+			}
+			{
+				string body = encodingProfilesSetsBody(elements);
+				measure("parseEncodingProfilesSets", elements, body, [&]() { CatraMMSAPI::parseEncodingProfilesSets(body); });
+			}
+			{
+				string body = encodersPoolBody(elements);
+				measure("parseEncodersPool", elements, body, [&]() { CatraMMSAPI::parseEncodersPool(body); });
+			}
+			{
+				string body = rtmpChannelConfsBody(elements);
+				measure("parseRTMPChannelConfs", elements, body, [&]() { CatraMMSAPI::parseRTMPChannelConfs(body); });
+			}
+			{
+				string body = srtChannelConfsBody(elements);
+				measure("parseSRTChannelConfs", elements, body, [&]() { CatraMMSAPI::parseSRTChannelConfs(body); });
+			}
+			{
+				string body = streamsBody(elements);
+				measure("parseStreams", elements, body, [&]() { CatraMMSAPI::parseStreams(body); });
+			}
+
+			// here an element is a built URL
+			measure(
+				"streamsURL", elements, "",
+				[&]()
+				{
+					for (int64_t index = 0; index < elements; index++)
+						_api.streamsURL(
+							_session, index * 50, 50, nullopt, "stream label/ä", true, nullopt, "IP_PULL", nullopt, nullopt, "EU", "IT", "asc", true
+						);
+				}
+			);
+			measure(
+				"rtmpChannelConfURL", elements, "",
+				[&]()
+				{
+					for (int64_t index = 0; index < elements; index++)
+						_api.rtmpChannelConfURL(_session, "rtmp label/ä", true, "SHARED", true);
+				}
+			);
+		}
+	}
+
+  private:
+	json _configurationRoot;
+	CatraMMSAPI _api;
+	CatraMMSAPI::Session _session;
+
+	// runs function at least 5 times and for at least 200 milliseconds, the values are the average of the runs
+	static void measure(const string &name, int64_t elements, const string &body, const function<void()> &function)
+	{
+		int64_t runs = 0;
+		uint64_t allocations = 0;
+		uint64_t bytes = 0;
+		chrono::nanoseconds elapsed(0);
+		while (runs < 5 || elapsed < chrono::milliseconds(200))
+		{
+			uint64_t allocationsBefore = allocationsNumber.load(memory_order_relaxed);
+			uint64_t bytesBefore = allocatedBytes.load(memory_order_relaxed);
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+			function();
+
+			elapsed += chrono::steady_clock::now() - start;
+			allocations += allocationsNumber.load(memory_order_relaxed) - allocationsBefore;
+			bytes += allocatedBytes.load(memory_order_relaxed) - bytesBefore;
+			runs++;
+		}
+
+		double perElement = static_cast<double>(runs * elements);
+		cout << std::format(
+			"{:<36} {:>8} {:>14.1f} {:>14.2f} {:>16.1f}{}\n", name, elements, elapsed.count() / perElement, allocations / perElement,
+			bytes / perElement, body.empty() ? "" : std::format("  (body: {} bytes)", body.size())
+		);
+	}
+
+	static string loginBody()
+	{
+		json workspaceRoot = {
+			{"workspaceKey", 1},
+			{"isEnabled", true},
+			{"workspaceName", "workspace"},
+			{"maxEncodingPriority", "high"},
+			{"encodingPeriod", "monthly"},
+			{"maxIngestionsNumber", 1000},
+			{"languageCode", "en"},
+			{"timezone", "Europe/Rome"},
+			{"preferences", json::object()},
+			{"creationDate", "2024-01-01T00:00:00Z"},
+			{"userAPIKey",
+			 {{"apiKey", "abcdefghijklmnopqrstuvwxyz"}, {"owner", true}, {"default", true}, {"expirationDate", "2030-01-01T00:00:00Z"}}},
+		};
+
+		return json{
+			{"userKey", 1},
+			{"name", "user"},
+			{"email", "user@catramms.com"},
+			{"country", "IT"},
+			{"timezone", "Europe/Rome"},
+			{"creationDate", "2024-01-01T00:00:00Z"},
+			{"expirationDate", "2030-01-01T00:00:00Z"},
+			{"mmsVersion", "1.0"},
+			{"workspace", workspaceRoot}
+		}
+			.dump();
+	}
+
+	static string ingestionWorkflowBody(int64_t elements)
+	{
+		json tasksRoot = json::array();
+		for (int64_t index = 0; index < elements; index++)
+			tasksRoot.push_back({{"ingestionJobKey", 1000 + index}, {"label", std::format("task {}", index)}});
+
+		return json{{"workflow", {{"ingestionRootKey", 1}, {"label", "workflow"}}}, {"tasks", tasksRoot}}.dump();
+	}
+
+	static json encodingProfileRoot(int64_t index)
+	{
+		json bitRatesRoot = json::array();
+		for (int32_t height : {360, 720, 1080})
+			bitRatesRoot.push_back(
+				{{"width", height * 16 / 9},
+				 {"height", height},
+				 {"kBitRate", height * 4},
+				 {"forceOriginalAspectRatio", "decrease"},
+				 {"pad", true},
+				 {"kMaxRate", height * 5},
+				 {"kBufferSize", height * 8}}
+			);
+
+		return {
+			{"encodingProfileKey", index},
+			{"global", true},
+			{"label", std::format("profile {}", index)},
+			{"contentType", "video"},
+			{"profile",
+			 {{"fileFormat", "mp4"},
+			  {"description", "H.264 ladder"},
+			  {"video",
+			   {{"codec", "libx264"},
+				{"profile", "high"},
+				{"twoPasses", false},
+				{"otherOutputParameters", ""},
+				{"frameRate", 25},
+				{"keyFrameIntervalInSeconds", 2},
+				{"bitRates", bitRatesRoot}}},
+			  {"audio",
+			   {{"codec", "aac"}, {"otherOutputParameters", ""}, {"channelsNumber", 2}, {"sampleRate", 48000}, {"bitRates", {{{"kBitRate", 128}}}}}}}}
+		};
+	}
+
+	static string encodingProfilesBody(int64_t elements)
+	{
+		json encodingProfilesRoot = json::array();
+		for (int64_t index = 0; index < elements; index++)
+			encodingProfilesRoot.push_back(encodingProfileRoot(index));
+
+		return json{{"response", {{"encodingProfiles", encodingProfilesRoot}}}}.dump();
+	}
+
+	// a single set with elements profiles
+	static string encodingProfilesSetsBody(int64_t elements)
+	{
+		json encodingProfilesRoot = json::array();
+		for (int64_t index = 0; index < elements; index++)
+			encodingProfilesRoot.push_back(encodingProfileRoot(index));
+
+		json encodingProfilesSetsRoot = json::array();
+		encodingProfilesSetsRoot.push_back(
+			{{"encodingProfilesSetKey", 1}, {"label", "set"}, {"contentType", "video"}, {"encodingProfiles", encodingProfilesRoot}}
+		);
+
+		return json{{"response", {{"encodingProfilesSets", encodingProfilesSetsRoot}}}}.dump();
+	}
+
+	// pools of 10 encoders, elements encoders
+	static string encodersPoolBody(int64_t elements)
+	{
+		json encodersPoolRoot = json::array();
+		for (int64_t index = 0; index < elements; index++)
+		{
+			if (index % 10 == 0)
+				encodersPoolRoot.push_back(
+					{{"encodersPoolKey", index / 10}, {"label", std::format("pool {}", index / 10)}, {"encoders", json::array()}}
+				);
+			encodersPoolRoot.back()["encoders"].push_back(
+				{{"encoderKey", index},
+				 {"label", std::format("encoder {}", index)},
+				 {"external", false},
+				 {"enabled", true},
+				 {"protocol", "https"},
+				 {"publicServerName", std::format("encoder-{}.catramms.com", index)},
+				 {"internalServerName", std::format("encoder-{}.internal", index)},
+				 {"port", 443},
+				 {"running", true},
+				 {"cpuUsage", index % 100},
+				 {"workspacesAssociated", {{{"workspaceKey", 1}, {"workspaceName", "workspace"}}}}}
+			);
+		}
+
+		return json{{"response", {{"encodersPool", encodersPoolRoot}}}}.dump();
+	}
+
+	static string rtmpChannelConfsBody(int64_t elements)
+	{
+		json rtmpChannelConfsRoot = json::array();
+		for (int64_t index = 0; index < elements; index++)
+			rtmpChannelConfsRoot.push_back(
+				{{"confKey", index},
+				 {"label", std::format("rtmp {}", index)},
+				 {"rtmpURL", std::format("rtmp://cdn.catramms.com/live/{}", index)},
+				 {"streamName", std::format("stream{}", index)},
+				 {"userName", "user"},
+				 {"password", "password"},
+				 {"playURLDetails", {{"playURL", std::format("https://cdn.catramms.com/live/{}.m3u8", index)}}},
+				 {"type", "SHARED"},
+				 {"outputIndex", -1},
+				 {"reservedByIngestionJobKey", -1},
+				 {"configurationLabel", ""}}
+			);
+
+		return json{{"response", {{"rtmpChannelConf", rtmpChannelConfsRoot}}}}.dump();
+	}
+
+	static string srtChannelConfsBody(int64_t elements)
+	{
+		json srtChannelConfsRoot = json::array();
+		for (int64_t index = 0; index < elements; index++)
+			srtChannelConfsRoot.push_back(
+				{{"confKey", index},
+				 {"label", std::format("srt {}", index)},
+				 {"srtURL", std::format("srt://cdn.catramms.com:{}", 9000 + index % 1000)},
+				 {"mode", "caller"},
+				 {"streamId", std::format("stream{}", index)},
+				 {"passphrase", "passphrase"},
+				 {"playURL", std::format("https://cdn.catramms.com/live/{}.m3u8", index)},
+				 {"type", "SHARED"},
+				 {"outputIndex", -1},
+				 {"reservedByIngestionJobKey", -1},
+				 {"configurationLabel", ""}}
+			);
+
+		return json{{"response", {{"srtChannelConf", srtChannelConfsRoot}}}}.dump();
+	}
+
+	static string streamsBody(int64_t elements)
+	{
+		json streamsRoot = json::array();
+		for (int64_t index = 0; index < elements; index++)
+			streamsRoot.push_back(
+				{{"confKey", index},
+				 {"label", std::format("stream {}", index)},
+				 {"sourceType", "IP_PULL"},
+				 {"encodersPoolKey", 1},
+				 {"encodersPoolLabel", "pool"},
+				 {"url", std::format("rtmp://source.catramms.com/live/{}", index)},
+				 {"pushProtocol", ""},
+				 {"pushEncoderKey", -1},
+				 {"pushPublicEncoderName", false},
+				 {"type", "TV"},
+				 {"description", ""},
+				 {"name", std::format("name {}", index)},
+				 {"region", "EU"},
+				 {"country", "IT"},
+				 {"imageMediaItemKey", -1},
+				 {"imageUniqueName", ""},
+				 {"position", index % 100},
+				 {"userData", json::object()}}
+			);
+
+		return json{{"response", {{"numFound", elements}, {"streams", streamsRoot}}}}.dump();
+	}
+};
+
+int main(int argc, char **argv)
+{
+	int64_t maxElements = argc > 1 ? stoll(argv[1]) : 100000;
+
+	spdlog::set_level(spdlog::level::warn);
+
+	// the URLs are built only, no call is done
+	// no lookup of the client public IP address: no network calls during the measures
+	json configurationRoot = {
+		{"mms",
+		 {{"api", {{"protocol", "https"}, {"hostname", "mms-api.catramms.com"}, {"port", 443}}}, {"clientIPAddress", {{"lookupURL", ""}}}}}
+	};
+	CatraMMSAPIBenchmark benchmark(configurationRoot);
+	benchmark.run(maxElements);
+
+	return 0;
+}
@@ -0,0 +1,435 @@
+#include "CatraMMSAPI.h"
+#include "CurlConnectionPool.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+using json = nlohmann::json;
+
+// Load generator of ingestionWorkflow: it submits workflows at a configured rate (open loop) or with a configured
+// concurrency (closed loop) and reports throughput, latency percentiles/histogram and the failures grouped by cause.
+// A sweep of mms->api->timeoutInSeconds and mms->api->maxRetries is run when more values are given. Usage:
+//		CatraMMSAPIWorkflowLoad [--protocol http] [--hostname 127.0.0.1] [--port 8088] [--userName u] [--password p]
+//			[--concurrency 8] [--rate <workflows per second, 0: as fast as possible>] [--durationInSeconds 10]
+//			[--timeoutsInSeconds 15[,5,...]] [--maxRetries 0[,1,...]]
+//			[--standIn] [--standInDelayInMilliSeconds 0] [--standInErrorPercentage 0]
+// --standIn starts, inside the process, a stand-in MMS endpoint (login and workflow only) listening on 127.0.0.1:<port>
+
+struct Options
+{
+	string protocol = "http";
+	string hostname = "127.0.0.1";
+	int port = 8088;
+	string userName = "user";
+	string password = "password";
+	int concurrency = 8;
+	double rate = 0;
+	int durationInSeconds = 10;
+	vector<int> timeoutsInSeconds = {15};
+	vector<int> maxRetries = {0};
+	bool standIn = false;
+	int standInDelayInMilliSeconds = 0;
+	int standInErrorPercentage = 0;
+};
+
+static vector<int> intList(const string &value)
+{
+	vector<int> values;
+	stringstream valueStream(value);
+	string item;
+	while (getline(valueStream, item, ','))
+		values.push_back(stoi(item));
+
+	return values;
+}
+
+static Options parseOptions(int argc, char **argv)
+{
+	Options options;
+
+	for (int index = 1; index < argc; index++)
+	{
+		string name = argv[index];
+		if (name == "--standIn")
+		{
+			options.standIn = true;
+			continue;
+		}
+		if (index + 1 >= argc)
+			throw runtime_error(std::format("Missing value, option: {}", name));
+		string value = argv[++index];
+
+		if (name == "--protocol")
+			options.protocol = value;
+		else if (name == "--hostname")
+			options.hostname = value;
+		else if (name == "--port")
+			options.port = stoi(value);
+		else if (name == "--userName")
+			options.userName = value;
+		else if (name == "--password")
+			options.password = value;
+		else if (name == "--concurrency")
+			options.concurrency = max(1, stoi(value));
+		else if (name == "--rate")
+			options.rate = stod(value);
+		else if (name == "--durationInSeconds")
+			options.durationInSeconds = stoi(value);
+		else if (name == "--timeoutsInSeconds")
+			options.timeoutsInSeconds = intList(value);
+		else if (name == "--maxRetries")
+			options.maxRetries = intList(value);
+		else if (name == "--standInDelayInMilliSeconds")
+			options.standInDelayInMilliSeconds = stoi(value);
+		else if (name == "--standInErrorPercentage")
+			options.standInErrorPercentage = stoi(value);
+		else
+			throw runtime_error(std::format("Unknown option: {}", name));
+	}
+
+	return options;
+}
+
+// minimal HTTP/1.1 (keep-alive) server answering login and workflow as MMS does, one thread per connection
+class StandInEndpoint
+{
+  public:
+	StandInEndpoint(int port, int delayInMilliSeconds, int errorPercentage)
+		: _delayInMilliSeconds(delayInMilliSeconds), _errorPercentage(errorPercentage)
+	{
+		_listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+		int reuseAddress = 1;
+		setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(port);
+		if (_listenSocket < 0 || ::bind(_listenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+			listen(_listenSocket, 1024) != 0)
+		{
+			string errorMessage = std::format(
+				"Stand-in endpoint failed"
+				", port: {}"
+				", errno: {}",
+				port, errno
+			);
+			SPDLOG_ERROR(errorMessage);
+
+			throw runtime_error(errorMessage);
+		}
+
+		thread(&StandInEndpoint::accept, this).detach();
+	}
+
+  private:
+	int _listenSocket;
+	int _delayInMilliSeconds;
+	int _errorPercentage;
+	atomic<int64_t> _ingestionRootKey = 0;
+
+	void accept()
+	{
+		while (true)
+		{
+			int connectionSocket = ::accept(_listenSocket, nullptr, nullptr);
+			if (connectionSocket < 0)
+				continue;
+			thread(&StandInEndpoint::serve, this, connectionSocket).detach();
+		}
+	}
+
+	void serve(int connectionSocket)
+	{
+		mt19937 generator(random_device{}());
+		uniform_int_distribution<int> percentage(0, 99);
+
+		string buffer;
+		char readBuffer[16384];
+		while (true)
+		{
+			size_t headersEnd;
+			while ((headersEnd = buffer.find("\r\n\r\n")) == string::npos)
+			{
+				ssize_t readBytes = read(connectionSocket, readBuffer, sizeof(readBuffer));
+				if (readBytes <= 0)
+				{
+					close(connectionSocket);
+					return;
+				}
+				buffer.append(readBuffer, readBytes);
+			}
+
+			string headers = buffer.substr(0, headersEnd);
+			size_t contentLength = 0;
+			{
+				string lowerHeaders = headers;
+				transform(lowerHeaders.begin(), lowerHeaders.end(), lowerHeaders.begin(), ::tolower);
+				if (size_t position = lowerHeaders.find("content-length:"); position != string::npos)
+					contentLength = stoul(lowerHeaders.substr(position + 15));
+			}
+			while (buffer.size() < headersEnd + 4 + contentLength)
+			{
+				ssize_t readBytes = read(connectionSocket, readBuffer, sizeof(readBuffer));
+				if (readBytes <= 0)
+				{
+					close(connectionSocket);
+					return;
+				}
+				buffer.append(readBuffer, readBytes);
+			}
+			buffer.erase(0, headersEnd + 4 + contentLength);
+
+			string requestLine = headers.substr(0, headers.find("\r\n"));
+
+			if (_delayInMilliSeconds > 0)
+				this_thread::sleep_for(chrono::milliseconds(_delayInMilliSeconds));
+
+			int httpCode = 200;
+			json responseRoot;
+			if (requestLine.find("/login ") != string::npos)
+				responseRoot = {
+					{"userKey", 1},
+					{"name", "user"},
+					{"mmsVersion", "stand-in"},
+					{"workspace", {{"workspaceKey", 1}, {"workspaceName", "workspace"}, {"userAPIKey", {{"apiKey", "apiKey"}}}}}
+				};
+			else if (requestLine.find("/workflow ") != string::npos)
+			{
+				if (percentage(generator) < _errorPercentage)
+				{
+					httpCode = 500;
+					responseRoot = {{"error", "stand-in failure"}};
+				}
+				else
+				{
+					int64_t ingestionRootKey = ++_ingestionRootKey;
+					responseRoot = {
+						{"workflow", {{"ingestionRootKey", ingestionRootKey}, {"label", "load"}}},
+						{"tasks", {{{"ingestionJobKey", ingestionRootKey * 10}, {"label", "task"}}}}
+					};
+				}
+			}
+			else
+			{
+				httpCode = 404;
+				responseRoot = {{"error", "not found"}};
+			}
+
+			string body = responseRoot.dump();
+			string response = std::format(
+				"HTTP/1.1 {} {}\r\nContent-Type: application/json\r\nContent-Length: {}\r\n\r\n{}", httpCode, httpCode == 200 ? "OK" : "Error",
+				body.size(), body
+			);
+			if (write(connectionSocket, response.data(), response.size()) != static_cast<ssize_t>(response.size()))
+			{
+				close(connectionSocket);
+				return;
+			}
+		}
+	}
+};
+
+// the cause is the failure without its variable parts (url, response, ...)
+static string failureCause(const exception &e)
+{
+	if (const CurlHttpError *httpError = dynamic_cast<const CurlHttpError *>(&e))
+		return std::format("HTTP {}", httpError->httpCode);
+
+	string what = e.what();
+	if (size_t position = what.find(", curlError: "); position != string::npos)
+		return what.substr(position + 13);
+
+	return what.substr(0, what.find(", "));
+}
+
+struct LoadResult
+{
+	int64_t sent = 0;
+	vector<int64_t> latenciesInMicroSeconds; // succeeded only
+	map<string, int64_t> failures;
+	chrono::steady_clock::duration elapsed;
+};
+
+static LoadResult runLoad(CatraMMSAPI &api, const Options &options)
+{
+	LoadResult loadResult;
+	mutex resultMutex;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	chrono::steady_clock::time_point end = start + chrono::seconds(options.durationInSeconds);
+	chrono::nanoseconds interval = options.rate > 0 ? chrono::nanoseconds(static_cast<int64_t>(1e9 / options.rate)) : chrono::nanoseconds(0);
+	atomic<int64_t> nextRequestIndex = 0;
+
+	vector<thread> workers;
+	for (int workerIndex = 0; workerIndex < options.concurrency; workerIndex++)
+		workers.emplace_back(
+			[&]()
+			{
+				vector<int64_t> latenciesInMicroSeconds;
+				map<string, int64_t> failures;
+				int64_t sent = 0;
+
+				while (true)
+				{
+					// with a rate, the latency is measured from the time the request was due to be sent, so that
+					// the time spent waiting for a free worker is not hidden
+					chrono::steady_clock::time_point requestStart = chrono::steady_clock::now();
+					if (options.rate > 0)
+					{
+						requestStart = start + interval * nextRequestIndex++;
+						if (requestStart >= end)
+							break;
+						this_thread::sleep_until(requestStart);
+					}
+					else if (requestStart >= end)
+						break;
+
+					sent++;
+					try
+					{
+						json workflowRoot = {
+							{"label", "load"},
+							{"type", "Workflow"},
+							{"task",
+							 {{"label", "task"},
+							  {"type", "Add-Content"},
+							  {"parameters", {{"fileFormat", "mp4"}, {"sourceURL", "https://example.com/a.mp4"}}}}}
+						};
+						api.ingestionWorkflow(workflowRoot);
+
+						chrono::steady_clock::duration latency = chrono::steady_clock::now() - requestStart;
+						latenciesInMicroSeconds.push_back(chrono::duration_cast<chrono::microseconds>(latency).count());
+					}
+					catch (exception &e)
+					{
+						failures[failureCause(e)]++;
+					}
+				}
+
+				lock_guard<mutex> locker(resultMutex);
+				loadResult.sent += sent;
+				loadResult.latenciesInMicroSeconds.insert(
+					loadResult.latenciesInMicroSeconds.end(), latenciesInMicroSeconds.begin(), latenciesInMicroSeconds.end()
+				);
+				for (auto &[cause, count] : failures)
+					loadResult.failures[cause] += count;
+			}
+		);
+	for (thread &worker : workers)
+		worker.join();
+
+	loadResult.elapsed = chrono::steady_clock::now() - start;
+
+	return loadResult;
+}
+
+static void report(LoadResult &loadResult, int timeoutInSeconds, int maxRetries)
+{
+	vector<int64_t> &latencies = loadResult.latenciesInMicroSeconds;
+	sort(latencies.begin(), latencies.end());
+
+	double elapsedInSeconds = chrono::duration<double>(loadResult.elapsed).count();
+	int64_t failed = loadResult.sent - static_cast<int64_t>(latencies.size());
+
+	cout << std::format("timeoutInSeconds: {}, maxRetries: {}\n", timeoutInSeconds, maxRetries);
+	cout << std::format(
+		"  sent: {}, succeeded: {}, failed: {}, elapsed: {:.1f}s, throughput: {:.1f} workflows/s\n", loadResult.sent, latencies.size(), failed,
+		elapsedInSeconds, latencies.size() / elapsedInSeconds
+	);
+
+	if (!latencies.empty())
+	{
+		auto percentile = [&latencies](double value) -> double
+		{ return latencies[min(latencies.size() - 1, static_cast<size_t>(value * latencies.size()))] / 1000.0; };
+		cout << std::format(
+			"  latency (ms): min {:.2f}, p50 {:.2f}, p99 {:.2f}, p999 {:.2f}, max {:.2f}\n", latencies.front() / 1000.0, percentile(0.5),
+			percentile(0.99), percentile(0.999), latencies.back() / 1000.0
+		);
+
+		// power of two buckets
+		map<int64_t, int64_t> histogram;
+		for (int64_t latency : latencies)
+		{
+			int64_t bucket = 1;
+			while (bucket < latency)
+				bucket *= 2;
+			histogram[bucket]++;
+		}
+		cout << "  latency histogram (ms):\n";
+		for (auto &[bucket, count] : histogram)
+			cout << std::format(
+				"    <= {:>10.3f}: {:>8} {}\n", bucket / 1000.0, count,
+				string(max<int64_t>(count * 50 / static_cast<int64_t>(latencies.size()), 1), '#')
+			);
+	}
+
+	if (!loadResult.failures.empty())
+	{
+		cout << "  failures:\n";
+		for (auto &[cause, count] : loadResult.failures)
+			cout << std::format("    {:>8}: {}\n", count, cause);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	try
+	{
+		Options options = parseOptions(argc, argv);
+
+		spdlog::set_level(spdlog::level::off);
+
+		unique_ptr<StandInEndpoint> standInEndpoint;
+		if (options.standIn)
+			standInEndpoint = make_unique<StandInEndpoint>(options.port, options.standInDelayInMilliSeconds, options.standInErrorPercentage);
+
+		cout << std::format(
+			"{}://{}:{}, concurrency: {}, rate: {}, durationInSeconds: {}\n", options.protocol, options.hostname, options.port, options.concurrency,
+			options.rate > 0 ? std::format("{}/s", options.rate) : "unlimited", options.durationInSeconds
+		);
+
+		for (int timeoutInSeconds : options.timeoutsInSeconds)
+			for (int maxRetries : options.maxRetries)
+			{
+				json configurationRoot = {
+					{"mms",
+					 {{"api",
+					   {{"protocol", options.protocol},
+						{"hostname", options.hostname},
+						{"port", options.port},
+						{"timeoutInSeconds", timeoutInSeconds},
+						{"maxRetries", maxRetries}}},
+					  // no lookup of the client public IP address, it is passed to login
+					  {"clientIPAddress", {{"lookupURL", ""}}}}}
+				};
+				CatraMMSAPI api(configurationRoot);
+				// the client IP address is passed to avoid its lookup
+				api.login(options.userName, options.password, "127.0.0.1");
+
+				LoadResult loadResult = runLoad(api, options);
+				report(loadResult, timeoutInSeconds, maxRetries);
+			}
+	}
+	catch (exception &e)
+	{
+		cerr << std::format("CatraMMSAPIWorkflowLoad failed, exception: {}\n", e.what());
+
+		return 1;
+	}
+
+	return 0;
+}
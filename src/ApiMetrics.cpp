@@ -0,0 +1,184 @@
+#include "ApiMetrics.h"
+
+#include <format>
+#include <limits>
+
+using namespace std;
+
+void ApiMetrics::Histogram::observe(chrono::steady_clock::duration duration)
+{
+	double seconds = chrono::duration<double>(duration).count();
+
+	size_t bucketIndex = 0;
+	while (bucketIndex < bucketBounds.size() && seconds > bucketBounds[bucketIndex])
+		bucketIndex++;
+	bucketCounts[bucketIndex]++;
+	count++;
+	sumInSeconds += seconds;
+}
+
+double ApiMetrics::Histogram::percentileInSeconds(double percentile) const
+{
+	if (count == 0)
+		return 0;
+
+	int64_t rank = static_cast<int64_t>(percentile * count);
+	int64_t cumulativeCount = 0;
+	for (size_t bucketIndex = 0; bucketIndex < bucketBounds.size(); bucketIndex++)
+	{
+		cumulativeCount += bucketCounts[bucketIndex];
+		if (cumulativeCount > rank)
+			return bucketBounds[bucketIndex];
+	}
+
+	return numeric_limits<double>::infinity();
+}
+
+ApiMetrics::Call::~Call()
+{
+	// the call failed in case it is left by an exception
+	if (_metrics)
+		_metrics->called(_api, chrono::steady_clock::now() - _start, uncaught_exceptions() > _uncaughtExceptions);
+}
+
+void ApiMetrics::called(const string &api, chrono::steady_clock::duration latency, bool failed)
+{
+	if (api.empty())
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	Api &metrics = _apis[api];
+	metrics.calls++;
+	if (failed)
+		metrics.failures++;
+	metrics.latency.observe(latency);
+}
+
+void ApiMetrics::retried(const string &api)
+{
+	if (api.empty())
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	_apis[api].retries++;
+}
+
+void ApiMetrics::coalesced(const string &api)
+{
+	if (api.empty())
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	_apis[api].coalesced++;
+}
+
+void ApiMetrics::hedged(const string &api)
+{
+	if (api.empty())
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	_apis[api].hedged++;
+}
+
+void ApiMetrics::transferred(const string &api, int64_t bytesSent, int64_t bytesReceived, chrono::steady_clock::duration transferTime)
+{
+	if (api.empty())
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	Api &metrics = _apis[api];
+	metrics.bytesSent += bytesSent;
+	metrics.bytesReceived += bytesReceived;
+	metrics.transferTime.observe(transferTime);
+}
+
+void ApiMetrics::decompressed(const string &api, chrono::steady_clock::duration duration)
+{
+	if (api.empty())
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	_apis[api].decompressionTime.observe(duration);
+}
+
+void ApiMetrics::parsed(const string &api, chrono::steady_clock::duration duration)
+{
+	if (api.empty())
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	_apis[api].parseTime.observe(duration);
+}
+
+map<string, ApiMetrics::Api> ApiMetrics::snapshot() const
+{
+	lock_guard<mutex> locker(_mutex);
+
+	return _apis;
+}
+
+ApiMetrics::Histogram ApiMetrics::transferTime(const string &api) const
+{
+	lock_guard<mutex> locker(_mutex);
+
+	auto it = _apis.find(api);
+	if (it == _apis.end())
+		return Histogram();
+
+	return it->second.transferTime;
+}
+
+string ApiMetrics::prometheus() const
+{
+	map<string, Api> apis = snapshot();
+
+	string text;
+
+	auto counter = [&apis, &text](const string &name, const string &help, int64_t Api::*value)
+	{
+		text += std::format("# HELP {} {}\n# TYPE {} counter\n", name, help, name);
+		for (auto &[api, metrics] : apis)
+			text += std::format("{}{{api=\"{}\"}} {}\n", name, api, metrics.*value);
+	};
+	auto histogram = [&apis, &text](const string &name, const string &help, Histogram Api::*value)
+	{
+		text += std::format("# HELP {} {}\n# TYPE {} histogram\n", name, help, name);
+		for (auto &[api, metrics] : apis)
+		{
+			const Histogram &histogram = metrics.*value;
+
+			// buckets are cumulative in the exposition format
+			int64_t cumulativeCount = 0;
+			for (size_t bucketIndex = 0; bucketIndex < bucketBounds.size(); bucketIndex++)
+			{
+				cumulativeCount += histogram.bucketCounts[bucketIndex];
+				text += std::format("{}_bucket{{api=\"{}\",le=\"{}\"}} {}\n", name, api, bucketBounds[bucketIndex], cumulativeCount);
+			}
+			text += std::format("{}_bucket{{api=\"{}\",le=\"+Inf\"}} {}\n", name, api, histogram.count);
+			text += std::format("{}_sum{{api=\"{}\"}} {}\n", name, api, histogram.sumInSeconds);
+			text += std::format("{}_count{{api=\"{}\"}} {}\n", name, api, histogram.count);
+		}
+	};
+
+	counter("catramms_api_calls_total", "API calls", &Api::calls);
+	counter("catramms_api_failures_total", "API calls failed", &Api::failures);
+	counter("catramms_api_retries_total", "HTTP retries", &Api::retries);
+	counter("catramms_api_coalesced_total", "API calls served by an identical call in flight", &Api::coalesced);
+	counter("catramms_api_hedged_total", "Hedge requests sent because the first request was slow", &Api::hedged);
+	counter("catramms_api_sent_bytes_total", "Bytes sent (headers included)", &Api::bytesSent);
+	counter("catramms_api_received_bytes_total", "Bytes received (headers included)", &Api::bytesReceived);
+	histogram("catramms_api_latency_seconds", "API call latency", &Api::latency);
+	histogram("catramms_api_transfer_seconds", "HTTP request transfer time", &Api::transferTime);
+	histogram("catramms_api_parse_seconds", "Response parse time", &Api::parseTime);
+	histogram("catramms_api_decompression_seconds", "Response decompression time", &Api::decompressionTime);
+
+	return text;
+}
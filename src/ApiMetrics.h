@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Per API counters and histograms: latency of the calls, retries, bytes sent/received,
+// HTTP transfer, decompression and parse time. The calls without api (empty) are not recorded.
+// Thread safe, it is shared by CatraMMSAPI (calls, parse) and CurlConnectionPool (transfers)
+class ApiMetrics
+{
+  public:
+	// upper bounds (seconds) of the histogram buckets, a last +Inf bucket follows
+	static constexpr std::array<double, 16> bucketBounds = {
+		0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+	};
+
+	struct Histogram
+	{
+		std::array<int64_t, bucketBounds.size() + 1> bucketCounts{}; // not cumulative
+		int64_t count = 0;
+		double sumInSeconds = 0;
+
+		void observe(std::chrono::steady_clock::duration duration);
+		double percentileInSeconds(double percentile) const; // upper bound of the bucket
+	};
+	struct Api
+	{
+		int64_t calls = 0;
+		int64_t failures = 0;
+		int64_t retries = 0;
+		int64_t coalesced = 0; // calls served by an identical call already in flight
+		int64_t hedged = 0;	   // second requests sent because the first one was slow
+		int64_t bytesSent = 0;
+		int64_t bytesReceived = 0;
+		Histogram latency;
+		Histogram transferTime; // every HTTP request (retries included), from the start to the last byte
+		Histogram parseTime;
+		Histogram decompressionTime;
+	};
+
+	// records a call of api (latency, failed or not) when it goes out of scope
+	class Call
+	{
+	  public:
+		Call(std::shared_ptr<ApiMetrics> metrics, std::string api)
+			: _metrics(std::move(metrics)), _api(std::move(api)), _start(std::chrono::steady_clock::now()),
+			  _uncaughtExceptions(std::uncaught_exceptions())
+		{
+		}
+		~Call();
+
+		Call(const Call &) = delete;
+		Call &operator=(const Call &) = delete;
+
+	  private:
+		std::shared_ptr<ApiMetrics> _metrics;
+		std::string _api;
+		std::chrono::steady_clock::time_point _start;
+		int _uncaughtExceptions;
+	};
+
+	void called(const std::string &api, std::chrono::steady_clock::duration latency, bool failed);
+	void retried(const std::string &api);
+	void coalesced(const std::string &api);
+	void hedged(const std::string &api);
+	void transferred(const std::string &api, int64_t bytesSent, int64_t bytesReceived, std::chrono::steady_clock::duration transferTime);
+	void decompressed(const std::string &api, std::chrono::steady_clock::duration duration);
+	void parsed(const std::string &api, std::chrono::steady_clock::duration duration);
+
+	// runs parse recording its duration as parse time of api
+	template <typename Parse> auto parse(const std::string &api, Parse &&parse)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		auto result = parse();
+		parsed(api, std::chrono::steady_clock::now() - start);
+
+		return result;
+	}
+
+	std::map<std::string, Api> snapshot() const;
+	// transfer time of api only, empty in case api was never called
+	Histogram transferTime(const std::string &api) const;
+	// Prometheus text exposition format, metrics catramms_api_* with the api label
+	std::string prometheus() const;
+
+  private:
+	mutable std::mutex _mutex;
+	std::map<std::string, Api> _apis;
+};
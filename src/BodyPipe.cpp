@@ -0,0 +1,84 @@
+#include "BodyPipe.h"
+
+using namespace std;
+
+bool BodyPipe::write(const char *data, size_t length)
+{
+	if (length == 0)
+		return true;
+
+	unique_lock<mutex> locker(_mutex);
+
+	_changed.wait(locker, [this]() { return _bufferedBytes < _maxBufferedBytes || _readerStopped; });
+	if (_readerStopped)
+		return false;
+
+	_chunks.emplace_back(data, length);
+	_bufferedBytes += length;
+	_written = true;
+	_changed.notify_all();
+
+	return true;
+}
+
+void BodyPipe::close()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	_closed = true;
+	_changed.notify_all();
+}
+
+void BodyPipe::stopReading()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	_readerStopped = true;
+	_chunks.clear();
+	_bufferedBytes = 0;
+	_changed.notify_all();
+}
+
+bool BodyPipe::written()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	return _written;
+}
+
+bool BodyPipe::readerStopped()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	return _readerStopped;
+}
+
+chrono::steady_clock::duration BodyPipe::readerWaitDuration()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	return _readerWaitDuration;
+}
+
+BodyPipe::int_type BodyPipe::underflow()
+{
+	unique_lock<mutex> locker(_mutex);
+
+	if (_chunks.empty() && !_closed)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		_changed.wait(locker, [this]() { return !_chunks.empty() || _closed; });
+		_readerWaitDuration += chrono::steady_clock::now() - start;
+	}
+	if (_chunks.empty())
+		return traits_type::eof();
+
+	_readChunk = std::move(_chunks.front());
+	_chunks.pop_front();
+	_bufferedBytes -= _readChunk.size();
+	_changed.notify_all();
+
+	setg(_readChunk.data(), _readChunk.data(), _readChunk.data() + _readChunk.size());
+
+	return traits_type::to_int_type(*gptr());
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string>
+
+// Response body handed, while it is received, from the transfer (writer) to a parser running
+// in another thread (reader, through std::istream). At most maxBufferedBytes are kept in memory,
+// beyond them the writer waits for the reader
+class BodyPipe : public std::streambuf
+{
+  public:
+	explicit BodyPipe(size_t maxBufferedBytes) : _maxBufferedBytes(maxBufferedBytes) {}
+
+	BodyPipe(const BodyPipe &) = delete;
+	BodyPipe &operator=(const BodyPipe &) = delete;
+
+	// false in case the reader stopped reading, the transfer has to be aborted
+	bool write(const char *data, size_t length);
+	// end of the body, the reader gets EOF once it read the buffered chunks
+	void close();
+	// called by the reader once it is not going to read anymore (i.e. parse error)
+	void stopReading();
+	// a retry would write the body again
+	bool written();
+	bool readerStopped();
+	// time the reader waited for the body
+	std::chrono::steady_clock::duration readerWaitDuration();
+
+  protected:
+	int_type underflow() override;
+
+  private:
+	size_t _maxBufferedBytes;
+
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::deque<std::string> _chunks;
+	size_t _bufferedBytes = 0;
+	bool _written = false;
+	bool _closed = false;
+	bool _readerStopped = false;
+	std::chrono::steady_clock::duration _readerWaitDuration{};
+
+	// chunk being read, owned by the reader
+	std::string _readChunk;
+};
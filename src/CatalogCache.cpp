@@ -0,0 +1,46 @@
+#include "CatalogCache.h"
+
+using namespace std;
+
+optional<CatalogCache::Entry> CatalogCache::get(const string &key)
+{
+	lock_guard<mutex> locker(_mutex);
+
+	auto it = _entries.find(key);
+	if (it == _entries.end())
+		return nullopt;
+
+	return it->second;
+}
+
+void CatalogCache::put(const string &key, Entry entry)
+{
+	lock_guard<mutex> locker(_mutex);
+
+	if (_entries.size() >= _maxEntries && !_entries.contains(key))
+	{
+		// first the expired entries, in case it is not enough, any entry
+		auto now = chrono::steady_clock::now();
+		erase_if(_entries, [now](const auto &keyAndEntry) { return keyAndEntry.second.expiration <= now; });
+		if (_entries.size() >= _maxEntries)
+			_entries.erase(_entries.begin());
+	}
+
+	_entries[key] = std::move(entry);
+}
+
+void CatalogCache::refresh(const string &key, chrono::steady_clock::time_point expiration)
+{
+	lock_guard<mutex> locker(_mutex);
+
+	auto it = _entries.find(key);
+	if (it != _entries.end())
+		it->second.expiration = expiration;
+}
+
+void CatalogCache::clear()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	_entries.clear();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <any>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// In-process cache of the catalog responses (encoding profiles, encoders pool, channel confs, ...)
+// already converted in the CatraMMSAPI structs. An entry is returned as it is until its expiration,
+// after that it is revalidated by the server using its ETag (If-None-Match / 304)
+class CatalogCache
+{
+  public:
+	struct Entry
+	{
+		std::shared_ptr<const std::any> value;
+		std::string eTag;
+		std::chrono::steady_clock::time_point expiration;
+	};
+
+	explicit CatalogCache(size_t maxEntries) : _maxEntries(maxEntries) {}
+
+	std::optional<Entry> get(const std::string &key);
+	void put(const std::string &key, Entry entry);
+	// the entry was revalidated by the server, it is valid until the new expiration
+	void refresh(const std::string &key, std::chrono::steady_clock::time_point expiration);
+	void clear();
+
+  private:
+	size_t _maxEntries;
+
+	std::mutex _mutex;
+	std::unordered_map<std::string, Entry> _entries;
+};
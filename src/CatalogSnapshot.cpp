@@ -0,0 +1,291 @@
+#include "CatalogSnapshot.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+constexpr char magic[8] = {'C', 'M', 'M', 'S', 'C', 'A', 'T', 'S'};
+
+struct EntryHeader
+{
+	uint32_t keyLength;
+	uint32_t eTagLength;
+	uint64_t bodyLength;
+};
+} // namespace
+
+CatalogSnapshot::CatalogSnapshot(string pathFileName, chrono::seconds saveInterval)
+	: _pathFileName(std::move(pathFileName)), _saveInterval(saveInterval), _mappedAddress(nullptr), _mappedLength(0), _changed(false),
+	  _lastSave(chrono::steady_clock::now())
+{
+	try
+	{
+		map();
+	}
+	catch (exception &e)
+	{
+		// a missing or broken snapshot just means the catalogs are requested to the server
+		LOG_WARN(
+			"Catalog snapshot not valid, ignored"
+			", pathFileName: {}"
+			", exception: {}",
+			_pathFileName, e.what()
+		);
+		unmap();
+	}
+}
+
+CatalogSnapshot::~CatalogSnapshot() { unmap(); }
+
+void CatalogSnapshot::map()
+{
+	if (!filesystem::exists(_pathFileName))
+		return;
+
+	int fd = open(_pathFileName.c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		string errorMessage = std::format(
+			"open failed"
+			", pathFileName: {}"
+			", errno: {}",
+			_pathFileName, errno
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(magic) + 2 * sizeof(uint32_t)))
+	{
+		close(fd);
+
+		string errorMessage = std::format(
+			"Catalog snapshot too short"
+			", pathFileName: {}",
+			_pathFileName
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	_mappedLength = fileStat.st_size;
+	void *mappedAddress = mmap(nullptr, _mappedLength, PROT_READ, MAP_PRIVATE, fd, 0);
+	int mmapErrno = errno;
+	close(fd);
+	if (mappedAddress == MAP_FAILED)
+	{
+		string errorMessage = std::format(
+			"mmap failed"
+			", pathFileName: {}"
+			", mappedLength: {}"
+			", errno: {}",
+			_pathFileName, _mappedLength, mmapErrno
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+	_mappedAddress = mappedAddress;
+
+	const char *data = static_cast<const char *>(_mappedAddress);
+	size_t offset = 0;
+	auto read = [&](void *destination, size_t length)
+	{
+		if (length > _mappedLength - offset)
+		{
+			string errorMessage = std::format(
+				"Catalog snapshot truncated"
+				", pathFileName: {}"
+				", offset: {}",
+				_pathFileName, offset
+			);
+			SPDLOG_ERROR(errorMessage);
+
+			throw runtime_error(errorMessage);
+		}
+		if (destination != nullptr)
+			memcpy(destination, data + offset, length);
+		offset += length;
+	};
+
+	char fileMagic[sizeof(magic)];
+	uint32_t fileFormatVersion;
+	uint32_t entriesNumber;
+	read(fileMagic, sizeof(fileMagic));
+	read(&fileFormatVersion, sizeof(fileFormatVersion));
+	read(&entriesNumber, sizeof(entriesNumber));
+	if (memcmp(fileMagic, magic, sizeof(magic)) != 0 || fileFormatVersion != formatVersion)
+	{
+		string errorMessage = std::format(
+			"Catalog snapshot of another format"
+			", pathFileName: {}"
+			", fileFormatVersion: {}"
+			", formatVersion: {}",
+			_pathFileName, fileFormatVersion, formatVersion
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	for (uint32_t entryIndex = 0; entryIndex < entriesNumber; entryIndex++)
+	{
+		EntryHeader entryHeader;
+		read(&entryHeader, sizeof(entryHeader));
+
+		size_t keyOffset = offset;
+		read(nullptr, entryHeader.keyLength);
+		size_t eTagOffset = offset;
+		read(nullptr, entryHeader.eTagLength);
+		size_t bodyOffset = offset;
+		read(nullptr, entryHeader.bodyLength);
+
+		_mappedEntries[string(data + keyOffset, entryHeader.keyLength)] = {
+			string_view(data + eTagOffset, entryHeader.eTagLength), string_view(data + bodyOffset, entryHeader.bodyLength)
+		};
+	}
+
+	LOG_INFO(
+		"Catalog snapshot mapped"
+		", pathFileName: {}"
+		", entries: {}"
+		", mappedLength: {}",
+		_pathFileName, _mappedEntries.size(), _mappedLength
+	);
+}
+
+void CatalogSnapshot::unmap()
+{
+	_mappedEntries.clear();
+	if (_mappedAddress != nullptr)
+		munmap(_mappedAddress, _mappedLength);
+	_mappedAddress = nullptr;
+	_mappedLength = 0;
+}
+
+optional<CatalogSnapshot::Entry> CatalogSnapshot::get(const string &key)
+{
+	auto it = _mappedEntries.find(key);
+	if (it == _mappedEntries.end())
+		return nullopt;
+
+	lock_guard<mutex> locker(_mutex);
+	if (!_usedKeys.insert(key).second || _updatedEntries.contains(key))
+		return nullopt;
+
+	return it->second;
+}
+
+void CatalogSnapshot::put(const string &key, string eTag, string body)
+{
+	lock_guard<mutex> locker(_mutex);
+
+	_updatedEntries[key] = make_pair(std::move(eTag), std::move(body));
+	_changed = true;
+
+	if (chrono::steady_clock::now() - _lastSave >= _saveInterval)
+		saveLocked();
+}
+
+void CatalogSnapshot::save()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	saveLocked();
+}
+
+void CatalogSnapshot::saveLocked()
+{
+	if (!_changed)
+		return;
+
+	// written on a temporary file (one for each process sharing the snapshot) and renamed,
+	// a crash never leaves a truncated snapshot. The mapping of the previous file stays valid
+	string temporaryPathFileName = std::format("{}.{}.tmp", _pathFileName, getpid());
+	// owner only: the cached confs include secrets (RTMP password, SRT passphrase)
+	int fd = open(temporaryPathFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd == -1 || fchmod(fd, 0600) != 0)
+	{
+		int openErrno = errno;
+		if (fd != -1)
+			close(fd);
+		string errorMessage = std::format(
+			"Failed to create the catalog snapshot"
+			", pathFileName: {}"
+			", errno: {}",
+			temporaryPathFileName, openErrno
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+	close(fd);
+
+	uint32_t entriesNumber = 0;
+	{
+		ofstream snapshotStream(temporaryPathFileName, ios::binary | ios::trunc);
+
+		auto writeEntry = [&](const string &key, string_view eTag, string_view body)
+		{
+			EntryHeader entryHeader{static_cast<uint32_t>(key.size()), static_cast<uint32_t>(eTag.size()), body.size()};
+			snapshotStream.write(reinterpret_cast<const char *>(&entryHeader), sizeof(entryHeader));
+			snapshotStream.write(key.data(), key.size());
+			snapshotStream.write(eTag.data(), eTag.size());
+			snapshotStream.write(body.data(), body.size());
+			entriesNumber++;
+		};
+
+		snapshotStream.write(magic, sizeof(magic));
+		snapshotStream.write(reinterpret_cast<const char *>(&formatVersion), sizeof(formatVersion));
+		// the entries number is written once known
+		snapshotStream.write(reinterpret_cast<const char *>(&entriesNumber), sizeof(entriesNumber));
+		for (auto &[key, eTagAndBody] : _updatedEntries)
+			writeEntry(key, eTagAndBody.first, eTagAndBody.second);
+		for (const string &key : _usedKeys)
+		{
+			if (_updatedEntries.contains(key))
+				continue;
+			const Entry &entry = _mappedEntries.at(key);
+			writeEntry(key, entry.eTag, entry.body);
+		}
+		snapshotStream.seekp(sizeof(magic) + sizeof(formatVersion));
+		snapshotStream.write(reinterpret_cast<const char *>(&entriesNumber), sizeof(entriesNumber));
+
+		if (!snapshotStream)
+		{
+			string errorMessage = std::format(
+				"Failed to write the catalog snapshot"
+				", pathFileName: {}",
+				temporaryPathFileName
+			);
+			SPDLOG_ERROR(errorMessage);
+
+			throw runtime_error(errorMessage);
+		}
+	}
+	filesystem::rename(temporaryPathFileName, _pathFileName);
+
+	_changed = false;
+	_lastSave = chrono::steady_clock::now();
+
+	LOG_INFO(
+		"Catalog snapshot saved"
+		", pathFileName: {}"
+		", entries: {}",
+		_pathFileName, entriesNumber
+	);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+// On-disk snapshot of the catalog responses (body and ETag by catalog cache key), so that a new process
+// has the catalogs at once and just revalidates them. The file is versioned binary and it is memory-mapped:
+// the bodies are parsed straight from the page cache.
+// File: magic, formatVersion, entries number, then for each entry key, eTag and body lengths followed by the bytes
+class CatalogSnapshot
+{
+  public:
+	static constexpr uint32_t formatVersion = 1;
+
+	struct Entry
+	{
+		std::string_view eTag;
+		std::string_view body;
+	};
+
+	// read only streambuf on a body, without copying it
+	class BodyBuffer : public std::streambuf
+	{
+	  public:
+		explicit BodyBuffer(std::string_view body)
+		{
+			char *begin = const_cast<char *>(body.data());
+			setg(begin, begin, begin + body.size());
+		}
+	};
+
+	// reads source appending to copy the bytes read: the body is kept while it is parsed
+	class TeeBuffer : public std::streambuf
+	{
+	  public:
+		TeeBuffer(std::streambuf *source, std::string &copy) : _source(source), _copy(copy) {}
+
+	  protected:
+		int_type underflow() override
+		{
+			if (_source->sgetc() == traits_type::eof())
+				return traits_type::eof();
+
+			std::streamsize bytesRead = _source->sgetn(_buffer, std::clamp<std::streamsize>(_source->in_avail(), 1, sizeof(_buffer)));
+			_copy.append(_buffer, bytesRead);
+			setg(_buffer, _buffer, _buffer + bytesRead);
+
+			return traits_type::to_int_type(_buffer[0]);
+		}
+
+	  private:
+		std::streambuf *_source;
+		std::string &_copy;
+		char _buffer[16 * 1024];
+	};
+
+	// pathFileName is mapped in case it exists and it is valid, otherwise the snapshot starts empty.
+	// The bodies put are saved at most every saveInterval
+	CatalogSnapshot(std::string pathFileName, std::chrono::seconds saveInterval);
+	~CatalogSnapshot();
+
+	CatalogSnapshot(const CatalogSnapshot &) = delete;
+	CatalogSnapshot &operator=(const CatalogSnapshot &) = delete;
+
+	// entry of the mapped file, returned only the first time (then the catalog cache has it).
+	// Its views are valid while this object exists
+	std::optional<Entry> get(const std::string &key);
+	void put(const std::string &key, std::string eTag, std::string body);
+	// the entries got or put by this process are written (temporary file renamed), in case something changed
+	void save();
+
+  private:
+	std::string _pathFileName;
+	std::chrono::seconds _saveInterval;
+
+	void *_mappedAddress;
+	size_t _mappedLength;
+	std::unordered_map<std::string, Entry> _mappedEntries;
+
+	std::mutex _mutex;
+	// mapped entries used by this process, the others are not saved again
+	std::unordered_set<std::string> _usedKeys;
+	// eTag, body
+	std::unordered_map<std::string, std::pair<std::string, std::string>> _updatedEntries;
+	bool _changed;
+	std::chrono::steady_clock::time_point _lastSave;
+
+	void map();
+	void unmap();
+	void saveLocked();
+};
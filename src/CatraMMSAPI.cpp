@@ -1,11 +1,24 @@
 
 #include "CatraMMSAPI.h"
+#include "BodyPipe.h"
+#include "CatalogSnapshot.h"
 #include "CurlWrapper.h"
+#include "EncoderPoolMonitor.h"
 #include "Datetime.h"
 #include "JsonPath.h"
-
+#include "JsonSaxReader.h"
+#include "SingleFlight.h"
+#include "StreamCatalog.h"
+#include "WorkerPool.h"
+
+#include <any>
+#include <cmath>
+#include <chrono>
+#include <condition_variable>
 #include <exception>
 #include <format>
+#include <future>
+#include <limits>
 #include <optional>
 #include <stdexcept>
 #include <tuple>
@@ -44,6 +57,63 @@ CatraMMSAPI::CatraMMSAPI(json &configurationRoot) : userProfile(), currentWorksp
 		_deliveryMaxRetries
 	);
 
+	// the retries of all the calls (api, binary): backoff with jitter, retry budget, circuit breaker by endpoint
+	_retryInitialBackoffInMilliSeconds = JsonPath(&configurationRoot)["mms"]["retry"]["initialBackoffInMilliSeconds"].as<int32_t>(200);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->retry->initialBackoffInMilliSeconds: {}",
+		_retryInitialBackoffInMilliSeconds
+	);
+
+	_retryMaxBackoffInMilliSeconds = JsonPath(&configurationRoot)["mms"]["retry"]["maxBackoffInMilliSeconds"].as<int32_t>(10000);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->retry->maxBackoffInMilliSeconds: {}",
+		_retryMaxBackoffInMilliSeconds
+	);
+
+	_retryBackoffMultiplier = JsonPath(&configurationRoot)["mms"]["retry"]["backoffMultiplier"].as<double>(2.0);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->retry->backoffMultiplier: {}",
+		_retryBackoffMultiplier
+	);
+
+	_retryBudgetWindowInSeconds = JsonPath(&configurationRoot)["mms"]["retry"]["budgetWindowInSeconds"].as<int32_t>(10);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->retry->budgetWindowInSeconds: {}",
+		_retryBudgetWindowInSeconds
+	);
+
+	_retryBudgetRatio = JsonPath(&configurationRoot)["mms"]["retry"]["budgetRatio"].as<double>(0.1);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->retry->budgetRatio: {}",
+		_retryBudgetRatio
+	);
+
+	_retryBudgetMinRetries = JsonPath(&configurationRoot)["mms"]["retry"]["budgetMinRetries"].as<int32_t>(10);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->retry->budgetMinRetries: {}",
+		_retryBudgetMinRetries
+	);
+
+	_circuitBreakerFailureThreshold = JsonPath(&configurationRoot)["mms"]["retry"]["circuitBreakerFailureThreshold"].as<int32_t>(5);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->retry->circuitBreakerFailureThreshold: {}",
+		_circuitBreakerFailureThreshold
+	);
+
+	_circuitBreakerOpenInSeconds = JsonPath(&configurationRoot)["mms"]["retry"]["circuitBreakerOpenInSeconds"].as<int32_t>(30);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->retry->circuitBreakerOpenInSeconds: {}",
+		_circuitBreakerOpenInSeconds
+	);
+
 	_httpVerbose = JsonPath(&configurationRoot)["mms"]["httpVerbose"].as<bool>(false);
 	LOG_DEBUG(
 		"Configuration item"
@@ -98,6 +168,14 @@ CatraMMSAPI::CatraMMSAPI(json &configurationRoot) : userProfile(), currentWorksp
 		_apiPort
 	);
 
+	// the concurrent API calls share one HTTP/2 connection (https only, negotiated by TLS)
+	_apiHTTP2 = JsonPath(&configurationRoot)["mms"]["api"]["http2"].as<bool>(false);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->http2: {}",
+		_apiHTTP2
+	);
+
 	_binaryProtocol = JsonPath(&configurationRoot)["mms"]["binary"]["protocol"].as<string>("https");
 	LOG_DEBUG(
 		"Configuration item"
@@ -119,6 +197,10 @@ CatraMMSAPI::CatraMMSAPI(json &configurationRoot) : userProfile(), currentWorksp
 		_binaryPort
 	);
 
+	// copied in every session
+	_apiURL = std::format("{}://{}:{}/catramms/1.0.1", _apiProtocol, _apiHostname, _apiPort);
+	_binaryURL = std::format("{}://{}:{}/catramms/1.0.1", _binaryProtocol, _binaryHostname, _binaryPort);
+
 	_binaryTimeoutInSeconds = JsonPath(&configurationRoot)["mms"]["binary"]["timeoutInSeconds"].as<int32_t>(180);
 	LOG_DEBUG(
 		"Configuration item"
@@ -133,6 +215,66 @@ CatraMMSAPI::CatraMMSAPI(json &configurationRoot) : userProfile(), currentWorksp
 		_binaryMaxRetries
 	);
 
+	_binaryMaxChunksInFlight = JsonPath(&configurationRoot)["mms"]["binary"]["maxChunksInFlight"].as<int32_t>(1);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->binary->maxChunksInFlight: {}",
+		_binaryMaxChunksInFlight
+	);
+
+	// the chunk size follows the measured throughput: every chunk should last about targetChunkDurationInSeconds
+	_binaryInitialChunkSizeInBytes = JsonPath(&configurationRoot)["mms"]["binary"]["initialChunkSizeInBytes"].as<int64_t>(100000000);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->binary->initialChunkSizeInBytes: {}",
+		_binaryInitialChunkSizeInBytes
+	);
+
+	_binaryMinChunkSizeInBytes = JsonPath(&configurationRoot)["mms"]["binary"]["minChunkSizeInBytes"].as<int64_t>(5000000);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->binary->minChunkSizeInBytes: {}",
+		_binaryMinChunkSizeInBytes
+	);
+
+	_binaryMaxChunkSizeInBytes = JsonPath(&configurationRoot)["mms"]["binary"]["maxChunkSizeInBytes"].as<int64_t>(1000000000);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->binary->maxChunkSizeInBytes: {}",
+		_binaryMaxChunkSizeInBytes
+	);
+
+	_binaryTargetChunkDurationInSeconds = JsonPath(&configurationRoot)["mms"]["binary"]["targetChunkDurationInSeconds"].as<int64_t>(30);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->binary->targetChunkDurationInSeconds: {}",
+		_binaryTargetChunkDurationInSeconds
+	);
+
+	// bandwidth cap shared by all the uploads of the process, 0: no cap
+	_binaryMaxBytesPerSecond = JsonPath(&configurationRoot)["mms"]["binary"]["maxBytesPerSecond"].as<int64_t>(0);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->binary->maxBytesPerSecond: {}",
+		_binaryMaxBytesPerSecond
+	);
+
+	// empty: uploads are not journaled and an interrupted ingestionBinary starts again from the beginning
+	_binaryUploadJournalDirectory = JsonPath(&configurationRoot)["mms"]["binary"]["uploadJournalDirectory"].as<string>("");
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->binary->uploadJournalDirectory: {}",
+		_binaryUploadJournalDirectory
+	);
+
+	// the chunks are sent straight from the page cache (mmap), the file must not be truncated during the upload
+	_binaryMemoryMappedUpload = JsonPath(&configurationRoot)["mms"]["binary"]["memoryMappedUpload"].as<bool>(false);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->binary->memoryMappedUpload: {}",
+		_binaryMemoryMappedUpload
+	);
+
 	_outputToBeCompressed = JsonPath(&configurationRoot)["mms"]["outputToBeCompressed"].as<bool>(true);
 	LOG_DEBUG(
 		"Configuration item"
@@ -140,7 +282,225 @@ CatraMMSAPI::CatraMMSAPI(json &configurationRoot) : userProfile(), currentWorksp
 		_outputToBeCompressed
 	);
 
-	_loginSuccessful = false;
+	// the catalogs are parsed while they are received, this is the part of the body buffered between transfer and parsing
+	_maxBufferedResponseBytes = JsonPath(&configurationRoot)["mms"]["api"]["maxBufferedResponseBytes"].as<int32_t>(1024 * 1024);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->maxBufferedResponseBytes: {}",
+		_maxBufferedResponseBytes
+	);
+
+	// Content-Encoding of the request bodies (i.e. workflows) larger than minBodySizeInBytes, empty: not compressed
+	_requestCompressionEncoding = JsonPath(&configurationRoot)["mms"]["api"]["requestCompression"]["encoding"].as<string>("");
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->requestCompression->encoding: {}",
+		_requestCompressionEncoding
+	);
+	if (!_requestCompressionEncoding.empty() && _requestCompressionEncoding != "gzip")
+	{
+		string errorMessage = std::format(
+			"Wrong mms->api->requestCompression->encoding, only gzip is supported"
+			", encoding: {}",
+			_requestCompressionEncoding
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	_requestCompressionMinBodySizeInBytes = JsonPath(&configurationRoot)["mms"]["api"]["requestCompression"]["minBodySizeInBytes"].as<int32_t>(16384);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->requestCompression->minBodySizeInBytes: {}",
+		_requestCompressionMinBodySizeInBytes
+	);
+
+	_requestCompressionLevel = JsonPath(&configurationRoot)["mms"]["api"]["requestCompression"]["level"].as<int32_t>(6);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->requestCompression->level: {}",
+		_requestCompressionLevel
+	);
+	_requestCompressionRejected = false;
+
+	_maxIdleConnectionsPerHost = JsonPath(&configurationRoot)["mms"]["connectionPool"]["maxIdleConnectionsPerHost"].as<int32_t>(8);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->connectionPool->maxIdleConnectionsPerHost: {}",
+		_maxIdleConnectionsPerHost
+	);
+
+	// public IP sent by login as remoteClientIPAddress when the caller does not provide it: configured here
+	// or looked up in background, started by the first login without IP (empty lookup url: not sent at all)
+	_clientIPAddress = JsonPath(&configurationRoot)["mms"]["clientIPAddress"]["address"].as<string>("");
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->clientIPAddress->address: {}",
+		_clientIPAddress
+	);
+
+	_clientIPAddressLookupURL = JsonPath(&configurationRoot)["mms"]["clientIPAddress"]["lookupURL"].as<string>("https://api.ipify.org?format=json");
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->clientIPAddress->lookupURL: {}",
+		_clientIPAddressLookupURL
+	);
+
+	_clientIPAddressLookupTimeoutInSeconds = JsonPath(&configurationRoot)["mms"]["clientIPAddress"]["lookupTimeoutInSeconds"].as<int32_t>(5);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->clientIPAddress->lookupTimeoutInSeconds: {}",
+		_clientIPAddressLookupTimeoutInSeconds
+	);
+
+	// how long login waits for a lookup still in progress, then it goes on without the IP
+	_clientIPAddressLookupDeadlineInMilliSeconds =
+		JsonPath(&configurationRoot)["mms"]["clientIPAddress"]["lookupDeadlineInMilliSeconds"].as<int32_t>(200);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->clientIPAddress->lookupDeadlineInMilliSeconds: {}",
+		_clientIPAddressLookupDeadlineInMilliSeconds
+	);
+
+	_cacheEnabled = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["enabled"].as<bool>(true);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->enabled: {}",
+		_cacheEnabled
+	);
+
+	_cacheMaxEntries = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["maxEntries"].as<int32_t>(1000);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->maxEntries: {}",
+		_cacheMaxEntries
+	);
+
+	// empty: no snapshot, the catalogs of a new process are always requested to the server
+	_cacheSnapshotPathFileName = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["snapshotPathFileName"].as<string>("");
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->snapshotPathFileName: {}",
+		_cacheSnapshotPathFileName
+	);
+
+	_cacheSnapshotSaveIntervalInSeconds = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["snapshotSaveIntervalInSeconds"].as<int32_t>(10);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->snapshotSaveIntervalInSeconds: {}",
+		_cacheSnapshotSaveIntervalInSeconds
+	);
+
+	// the catalog GETs not answered within the latencyPercentile of their transfer time (measured by the library)
+	// are sent again and the first response wins
+	_hedgingEnabled = JsonPath(&configurationRoot)["mms"]["api"]["hedging"]["enabled"].as<bool>(false);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->hedging->enabled: {}",
+		_hedgingEnabled
+	);
+
+	_hedgingLatencyPercentile = JsonPath(&configurationRoot)["mms"]["api"]["hedging"]["latencyPercentile"].as<double>(0.95);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->hedging->latencyPercentile: {}",
+		_hedgingLatencyPercentile
+	);
+
+	// transfers to be measured before the first hedge request
+	_hedgingMinSamples = JsonPath(&configurationRoot)["mms"]["api"]["hedging"]["minSamples"].as<int32_t>(20);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->hedging->minSamples: {}",
+		_hedgingMinSamples
+	);
+
+	// threads parsing the responses received by the event loop, the loop thread only moves the bytes
+	_workerThreads = JsonPath(&configurationRoot)["mms"]["api"]["workerThreads"].as<int32_t>(4);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->workerThreads: {}",
+		_workerThreads
+	);
+
+	_encodingProfilesCacheTTLInSeconds = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["encodingProfilesTTLInSeconds"].as<int32_t>(300);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->encodingProfilesTTLInSeconds: {}",
+		_encodingProfilesCacheTTLInSeconds
+	);
+
+	_encodingProfilesSetsCacheTTLInSeconds = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["encodingProfilesSetsTTLInSeconds"].as<int32_t>(300);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->encodingProfilesSetsTTLInSeconds: {}",
+		_encodingProfilesSetsCacheTTLInSeconds
+	);
+
+	// running and cpuUsage of the encoders change frequently
+	_encodersPoolCacheTTLInSeconds = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["encodersPoolTTLInSeconds"].as<int32_t>(10);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->encodersPoolTTLInSeconds: {}",
+		_encodersPoolCacheTTLInSeconds
+	);
+
+	_rtmpChannelConfCacheTTLInSeconds = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["rtmpChannelConfTTLInSeconds"].as<int32_t>(60);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->rtmpChannelConfTTLInSeconds: {}",
+		_rtmpChannelConfCacheTTLInSeconds
+	);
+
+	_srtChannelConfCacheTTLInSeconds = JsonPath(&configurationRoot)["mms"]["api"]["cache"]["srtChannelConfTTLInSeconds"].as<int32_t>(60);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->api->cache->srtChannelConfTTLInSeconds: {}",
+		_srtChannelConfCacheTTLInSeconds
+	);
+
+	_encoderPoolMonitorRefreshIntervalInSeconds =
+		JsonPath(&configurationRoot)["mms"]["encoderPoolMonitor"]["refreshIntervalInSeconds"].as<int32_t>(5);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->encoderPoolMonitor->refreshIntervalInSeconds: {}",
+		_encoderPoolMonitorRefreshIntervalInSeconds
+	);
+
+	_streamCatalogRefreshIntervalInSeconds = JsonPath(&configurationRoot)["mms"]["streamCatalog"]["refreshIntervalInSeconds"].as<int32_t>(60);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->streamCatalog->refreshIntervalInSeconds: {}",
+		_streamCatalogRefreshIntervalInSeconds
+	);
+
+	_streamCatalogPageSize = JsonPath(&configurationRoot)["mms"]["streamCatalog"]["pageSize"].as<int32_t>(1000);
+	LOG_DEBUG(
+		"Configuration item"
+		", mms->streamCatalog->pageSize: {}",
+		_streamCatalogPageSize
+	);
+
+	_catalogCache = make_shared<CatalogCache>(_cacheMaxEntries);
+	_inFlightGets = make_shared<SingleFlight>();
+	if (_cacheEnabled && !_cacheSnapshotPathFileName.empty())
+		_catalogSnapshot = make_shared<CatalogSnapshot>(_cacheSnapshotPathFileName, chrono::seconds(_cacheSnapshotSaveIntervalInSeconds));
+
+	_metrics = make_shared<ApiMetrics>();
+	auto retryPolicy = make_shared<RetryPolicy>(
+		chrono::milliseconds(_retryInitialBackoffInMilliSeconds), chrono::milliseconds(_retryMaxBackoffInMilliSeconds), _retryBackoffMultiplier,
+		chrono::seconds(_retryBudgetWindowInSeconds), _retryBudgetRatio, _retryBudgetMinRetries, _circuitBreakerFailureThreshold,
+		chrono::seconds(_circuitBreakerOpenInSeconds)
+	);
+	_connectionPool = make_shared<CurlConnectionPool>(
+		_proxyURL, _proxyUsername, _proxyPassword, _httpSSLVersion, _httpVerbose, _maxIdleConnectionsPerHost, _binaryMemoryMappedUpload, _metrics,
+		retryPolicy, _apiHTTP2 ? CurlConnectionPool::origin(_apiURL) : "",
+		make_shared<UploadPacer>(
+			_binaryInitialChunkSizeInBytes, _binaryMinChunkSizeInBytes, _binaryMaxChunkSizeInBytes,
+			chrono::seconds(_binaryTargetChunkDurationInSeconds), _binaryMaxBytesPerSecond
+		)
+	);
 
 	{
 		videoFileFormats.emplace_back("mp4");
@@ -175,52 +535,38 @@ CatraMMSAPI::CatraMMSAPI(json &configurationRoot) : userProfile(), currentWorksp
 	}
 }
 
-void CatraMMSAPI::login(string userName, string password, string clientIPAddress)
+CatraMMSAPI::~CatraMMSAPI()
 {
-	if (clientIPAddress.empty())
-	{
-		try
-		{
-			string url = "https://api.ipify.org?format=json";
-			LOG_INFO(
-				"httpGetJson"
-				", url: {}"
-				", apiTimeoutInSeconds: {}",
-				url, _apiTimeoutInSeconds
-			);
-			json clientIPRoot = CurlWrapper::httpGetJson(url, _apiTimeoutInSeconds, "", std::vector<string>(),
-				"", 0, 15, false,
-				_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-				_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-				_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-				_httpSSLVersion.empty() ? std::nullopt : std::optional(_httpSSLVersion), _httpVerbose
-			);
-			clientIPAddress = JsonPath(&clientIPRoot)["ip"].as<string>();
-			LOG_INFO(
-				"httpGetJson"
-				", url: {}"
-				", clientIPAddress: {}",
-				url, clientIPAddress
-			);
-		}
-		catch (exception &e)
-		{
-			string errorMessage = std::format(
-				"localIPAddresses failed"
-				", exception: {}",
-				e.what()
-			);
-			SPDLOG_ERROR(errorMessage);
+	// their threads call this object, a caller keeping them gets only the last snapshot
+	if (_encoderPoolMonitor)
+		_encoderPoolMonitor->stop();
+	if (_streamCatalog)
+		_streamCatalog->stop();
+	// the transfers in flight are aborted and the responses already received are parsed (and put in the snapshot)
+	_eventLoop.reset();
+	_workerPool.reset();
 
-			// throw;
-		}
+	try
+	{
+		saveCatalogSnapshot();
+	}
+	catch (exception &)
+	{
+		// already logged
 	}
+}
+
+void CatraMMSAPI::login(string userName, string password, string clientIPAddress)
+{
+	string api = "login";
+	ApiMetrics::Call call(_metrics, api);
+
+	if (clientIPAddress.empty())
+		clientIPAddress = lookedUpClientIPAddress();
 
 	try
 	{
-		_loginSuccessful = false;
-
-		string url = std::format("{}://{}:{}/catramms/1.0.1/login", _apiProtocol, _apiHostname, _apiPort);
+		string url = std::format("{}/login", _apiURL);
 
 		json bodyRoot;
 
@@ -236,20 +582,29 @@ void CatraMMSAPI::login(string userName, string password, string clientIPAddress
 			", body: {}",
 			url, _httpVerbose, "..." // JSONUtils::toString(bodyRoot) commentato per evitare di mostrare la password
 		);
-		json mmsInfoRoot = CurlWrapper::httpPostStringAndGetJson(
-			url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(userName, password), JSONUtils::toString(bodyRoot),
-			"application/json", std::vector<std::string>(), "", 0,
-			15, false,
-			_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-			_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-			_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-			_httpSSLVersion, _httpVerbose
-		);
+		string responseBody;
+		if (_apiHTTP2)
+		{
+			// the connection is opened by the event loop, to be multiplexed by the following calls
+			CurlConnectionPool::HttpRequest request{
+				url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(userName, password), {}, JSONUtils::toString(bodyRoot), "application/json",
+				false, false, api
+			};
+			responseBody = eventLoop()->perform(std::move(request), 0).body;
+		}
+		else
+			responseBody = _connectionPool->httpPostString(
+				url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(userName, password), JSONUtils::toString(bodyRoot),
+				"application/json", std::vector<std::string>(), 0, false, api
+			);
 
-		userProfile = fillUserProfile(mmsInfoRoot);
-		userProfile.password = password;
+		auto session = make_shared<Session>();
+		bool workspacePresent = _metrics->parse(
+			api, [&]() { return parseLogin(responseBody, session->userProfile, session->workspaceDetails, session->mmsVersion); }
+		);
+		session->userProfile.password = password;
 
-		if (!JSONUtils::isPresent(mmsInfoRoot, "workspace"))
+		if (!workspacePresent)
 		{
 			string errorMessage = std::format("No valid Workspace available for the User. Please contact the administrator"
 				", userName: {}", userName);
@@ -257,13 +612,20 @@ void CatraMMSAPI::login(string userName, string password, string clientIPAddress
 
 			throw runtime_error(errorMessage);
 		}
-		currentWorkspaceDetails = fillWorkspaceDetails(mmsInfoRoot["workspace"]);
+		session->authorization =
+			CurlWrapper::basicAuthorization(std::format("{}", session->userProfile.userKey), session->workspaceDetails.apiKey);
+		session->apiURL = _apiURL;
+		session->binaryURL = _binaryURL;
+
+		userProfile = session->userProfile;
+		currentWorkspaceDetails = session->workspaceDetails;
+		mmsVersion = session->mmsVersion;
 
-		mmsVersion = JsonPath(&mmsInfoRoot)["mmsVersion"].as<string>("");
+		// the calls in progress keep the previous session, a failed login leaves the previous session in place
+		_session.store(std::move(session));
 
-		_userName = userName;
-		_password = password;
-		_loginSuccessful = true;
+		// the cached catalogs belong to the previous user/workspace
+		_catalogCache->clear();
 	}
 	catch (exception &e)
 	{
@@ -282,8 +644,10 @@ void CatraMMSAPI::login(string userName, string password, string clientIPAddress
 pair<CatraMMSAPI::IngestionResult, vector<CatraMMSAPI::IngestionResult>> CatraMMSAPI::ingestionWorkflow(json workflowRoot)
 {
 	string api = "ingestionWorkflow";
+	ApiMetrics::Call call(_metrics, api);
 
-	if (!_loginSuccessful)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
 		string errorMessage = "login API was not called yet";
 		SPDLOG_ERROR(errorMessage);
@@ -293,48 +657,16 @@ pair<CatraMMSAPI::IngestionResult, vector<CatraMMSAPI::IngestionResult>> CatraMM
 
 	try
 	{
-		string url = std::format("{}://{}:{}/catramms/1.0.1/workflow", _apiProtocol, _apiHostname, _apiPort);
+		string url = std::format("{}/workflow", session->apiURL);
 
 		LOG_INFO(
-			"httpGetJson"
-			", url: {}"
-			", _outputToBeCompressed: {}",
-			url, _outputToBeCompressed
-		);
-		vector<string> otherHeaders;
-		json mmsInfoRoot = CurlWrapper::httpPostStringAndGetJson(
-			url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(std::format("{}", userProfile.userKey),
-				currentWorkspaceDetails.apiKey), JSONUtils::toString(workflowRoot), "application/json",
-				vector<string>(), "", _apiMaxRetries, 15, false,
-				_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-				_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-				_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-				_httpSSLVersion, _httpVerbose
+			"httpPostStringAndGetJson"
+			", url: {}",
+			url
 		);
+		string responseBody = httpPostJson(*session, api, url, JSONUtils::toString(workflowRoot));
 
-		IngestionResult workflowResult;
-		{
-			auto workflowRoot = JsonPath(&mmsInfoRoot)["workflow"].as<json>();
-
-			workflowResult.key = JsonPath(&workflowRoot)["ingestionRootKey"].as<int64_t>(-1);
-			workflowResult.label = JsonPath(&workflowRoot)["label"].as<string>("");
-		}
-
-		vector<IngestionResult> ingestionJobs;
-		{
-			json tasksRoot = JsonPath(&mmsInfoRoot)["tasks"].as<json>(json::array());
-			for (auto &[keyRoot, valRoot] : tasksRoot.items())
-			{
-				IngestionResult ingestionJobResult;
-
-				ingestionJobResult.key = JsonPath(&valRoot)["ingestionJobKey"].as<int64_t>(-1);
-				ingestionJobResult.label = JsonPath(&valRoot)["label"].as<string>();
-
-				ingestionJobs.push_back(ingestionJobResult);
-			}
-		}
-
-		return make_pair(workflowResult, ingestionJobs);
+		return _metrics->parse(api, [&]() { return parseIngestionWorkflow(responseBody); });
 	}
 	catch (exception &e)
 	{
@@ -349,11 +681,14 @@ pair<CatraMMSAPI::IngestionResult, vector<CatraMMSAPI::IngestionResult>> CatraMM
 	}
 }
 
-void CatraMMSAPI::ingestionBinary(int64_t addContentIngestionJobKey, const string& pathFileName, function<bool(int, int)> chunkCompleted)
+vector<CatraMMSAPI::IngestionWorkflowBatchResult>
+CatraMMSAPI::ingestionWorkflowBatch(const vector<json> &workflowRoots, int maxConcurrency, const function<void(int64_t, int64_t)> &progress)
 {
-	string api = "ingestionBinary";
+	string api = "ingestionWorkflowBatch";
+	ApiMetrics::Call call(_metrics, api);
 
-	if (!_loginSuccessful)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
 		string errorMessage = "login API was not called yet";
 		SPDLOG_ERROR(errorMessage);
@@ -361,46 +696,153 @@ void CatraMMSAPI::ingestionBinary(int64_t addContentIngestionJobKey, const strin
 		throw runtime_error(errorMessage);
 	}
 
-	try
-	{
-		string url = std::format("{}://{}:{}/catramms/1.0.1/binary/{}", _binaryProtocol, _binaryHostname, _binaryPort,
-			addContentIngestionJobKey);
-
-		LOG_INFO(
-			"httpGetJson"
-			", url: {}"
-			", _outputToBeCompressed: {}",
-			url, _outputToBeCompressed
-		);
+	string url = std::format("{}/workflow", session->apiURL);
+	int64_t workflowsNumber = workflowRoots.size();
+	maxConcurrency = max(maxConcurrency, 1);
 
-		string sResponse = CurlWrapper::httpPostFileSplittingInChunks(
-			url, _binaryTimeoutInSeconds, CurlWrapper::basicAuthorization(std::format("{}", userProfile.userKey),
-			currentWorkspaceDetails.apiKey), pathFileName, chunkCompleted, "", _binaryMaxRetries,
-			_binaryTimeoutInSeconds,
-			_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-			_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-			_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-			_httpSSLVersion, _httpVerbose
+	LOG_INFO(
+		"ingestionWorkflowBatch"
+		", url: {}"
+		", workflowsNumber: {}"
+		", maxConcurrency: {}",
+		url, workflowsNumber, maxConcurrency
 	);
-	}
-	catch (exception &e)
+
+	// the completions run in the event loop thread, they only update the results and the counters,
+	// submissions and progress are done by this thread. The state is shared with the completions:
+	// in case this thread leaves because of an exception, the workflows still in flight complete on it
+	struct Batch
 	{
-		string errorMessage = std::format(
-			"{} failed"
-			", exception: {}",
-			api, e.what()
-		);
-		SPDLOG_ERROR(errorMessage);
+		vector<IngestionWorkflowBatchResult> results;
+		mutex batchMutex;
+		condition_variable batchChanged;
+		int inFlight = 0;
+		int64_t completed = 0;
+	};
+	auto batch = make_shared<Batch>();
+	batch->results.resize(workflowsNumber);
+
+	int64_t submitted = 0;
+	int64_t reported = 0;
+	while (reported < workflowsNumber)
+	{
+		bool toBeSubmitted;
+		int64_t completedNow;
+		{
+			unique_lock<mutex> locker(batch->batchMutex);
+			batch->batchChanged.wait(
+				locker, [&]() { return batch->completed > reported || (submitted < workflowsNumber && batch->inFlight < maxConcurrency); }
+			);
+			toBeSubmitted = submitted < workflowsNumber && batch->inFlight < maxConcurrency;
+			if (toBeSubmitted)
+				batch->inFlight++;
+			completedNow = batch->completed;
+		}
 
-		throw;
-	}
-}
+		if (completedNow > reported)
+		{
+			reported = completedNow;
+			if (progress != nullptr)
+				progress(reported, workflowsNumber);
+		}
 
-vector<CatraMMSAPI::EncodingProfile> CatraMMSAPI::getEncodingProfiles(string contentType, int64_t encodingProfileKey, string label, bool cacheAllowed)
+		if (toBeSubmitted)
+		{
+			int64_t workflowIndex = submitted++;
+
+			try
+			{
+				submitPostJson(
+					*session, api, url, JSONUtils::toString(workflowRoots[workflowIndex]),
+					[this, batch, api, workflowIndex](CurlConnectionPool::HttpResponse &&response, exception_ptr error)
+					{
+						// not parsed by the event loop thread, it would stop the other transfers
+						workerPool()->post(
+							[this, batch, api, workflowIndex, response = std::move(response), error]()
+							{
+								IngestionWorkflowBatchResult &result = batch->results[workflowIndex];
+								try
+								{
+									if (error)
+										rethrow_exception(error);
+
+									result.ingestionResults = _metrics->parse(api, [&]() { return parseIngestionWorkflow(response.body); });
+								}
+								catch (exception &e)
+								{
+									SPDLOG_ERROR(
+										"{} failed"
+										", workflowIndex: {}"
+										", exception: {}",
+										api, workflowIndex, e.what()
+									);
+									result.error = current_exception();
+								}
+
+								lock_guard<mutex> locker(batch->batchMutex);
+								batch->inFlight--;
+								batch->completed++;
+								batch->batchChanged.notify_one();
+							}
+						);
+					}
+				);
+			}
+			catch (exception &e)
+			{
+				// the workflow was not sent, its error is recorded and the batch goes on
+				SPDLOG_ERROR(
+					"{} submit failed"
+					", workflowIndex: {}"
+					", exception: {}",
+					api, workflowIndex, e.what()
+				);
+
+				lock_guard<mutex> locker(batch->batchMutex);
+				batch->results[workflowIndex].error = current_exception();
+				batch->inFlight--;
+				batch->completed++;
+			}
+		}
+	}
+
+	// all the workflows completed, no completion refers to the results anymore
+	return std::move(batch->results);
+}
+
+future<pair<CatraMMSAPI::IngestionResult, vector<CatraMMSAPI::IngestionResult>>> CatraMMSAPI::ingestionWorkflowAsync(json workflowRoot)
 {
-	string api = "getEncodingProfiles";
+	string api = "ingestionWorkflowAsync";
+
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
+	{
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	string url = std::format("{}/workflow", session->apiURL);
+
+	LOG_INFO(
+		"httpPostStringAndGetJson"
+		", url: {}",
+		url
+	);
+
+	return postJsonAsync<pair<IngestionResult, vector<IngestionResult>>>(
+		*session, api, url, JSONUtils::toString(workflowRoot), parseIngestionWorkflow
+	);
+}
+
+void CatraMMSAPI::ingestionBinary(int64_t addContentIngestionJobKey, const string& pathFileName, function<bool(int, int)> chunkCompleted)
+{
+	string api = "ingestionBinary";
+	ApiMetrics::Call call(_metrics, api);
 
-	if (!_loginSuccessful)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
 		string errorMessage = "login API was not called yet";
 		SPDLOG_ERROR(errorMessage);
@@ -410,16 +852,7 @@ vector<CatraMMSAPI::EncodingProfile> CatraMMSAPI::getEncodingProfiles(string con
 
 	try
 	{
-		string url = std::format("{}://{}:{}/catramms/1.0.1/encodingProfiles/{}", _apiProtocol, _apiHostname, _apiPort, contentType);
-		if (encodingProfileKey != -1)
-			url += std::format("/{}", encodingProfileKey);
-		char queryChar = '?';
-		if (!label.empty())
-		{
-			url += std::format("{}label={}", queryChar, CurlWrapper::escape(label));
-			queryChar = '&';
-		}
-		url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+		string url = std::format("{}/binary/{}", session->binaryURL, addContentIngestionJobKey);
 
 		LOG_INFO(
 			"httpGetJson"
@@ -427,28 +860,31 @@ vector<CatraMMSAPI::EncodingProfile> CatraMMSAPI::getEncodingProfiles(string con
 			", _outputToBeCompressed: {}",
 			url, _outputToBeCompressed
 		);
-		vector<string> otherHeaders;
-		if (_outputToBeCompressed)
-			otherHeaders.push_back("X-ResponseBodyCompressed: true");
-		json mmsInfoRoot = CurlWrapper::httpGetJson(
-			url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(std::format("{}", userProfile.userKey), currentWorkspaceDetails.apiKey),
-			otherHeaders, "", _apiMaxRetries, 15, _outputToBeCompressed,
-			_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-			_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-			_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-			_httpSSLVersion, _httpVerbose
-		);
-
-		json responseRoot = JsonPath(&mmsInfoRoot)["response"].as<json>();
-		json encodingProfilesRoot = JsonPath(&responseRoot)["encodingProfiles"].as<json>(json::array());
 
-		vector<EncodingProfile> encodingProfiles;
+		optional<UploadJournal> uploadJournal;
+		if (!_binaryUploadJournalDirectory.empty())
+			uploadJournal.emplace(_binaryUploadJournalDirectory, addContentIngestionJobKey, pathFileName);
 
-		bool deep = false;
-		for (auto &[keyRoot, valRoot] : encodingProfilesRoot.items())
-			encodingProfiles.push_back(fillEncodingProfile(valRoot, deep));
+		bool uploadStopped = false;
+		function<bool(int, int, int64_t)> journaledChunkCompleted = [&](int chunkIndex, int chunksNumber, int64_t uploadedBytes)
+		{
+			if (uploadJournal)
+				uploadJournal->acknowledged(chunkIndex + 1, uploadedBytes);
+			if (chunkCompleted != nullptr)
+				uploadStopped = chunkCompleted(chunkIndex, chunksNumber);
+
+			return uploadStopped;
+		};
+
+		string sResponse = _connectionPool->httpPostFileSplittingInChunks(
+			url, _binaryTimeoutInSeconds, session->authorization, pathFileName, journaledChunkCompleted, _binaryMaxRetries,
+			_binaryMaxChunksInFlight, uploadJournal ? uploadJournal->firstChunkToBeSent() : 0,
+			uploadJournal ? uploadJournal->firstByteToBeSent() : 0, api
+		);
 
-		return encodingProfiles;
+		// a stopped upload keeps its journal, it can be resumed later
+		if (uploadJournal && !uploadStopped)
+			uploadJournal->remove();
 	}
 	catch (exception &e)
 	{
@@ -463,11 +899,13 @@ vector<CatraMMSAPI::EncodingProfile> CatraMMSAPI::getEncodingProfiles(string con
 	}
 }
 
-vector<CatraMMSAPI::EncodingProfilesSet> CatraMMSAPI::getEncodingProfilesSets(string contentType, bool cacheAllowed)
+vector<CatraMMSAPI::EncodingProfile> CatraMMSAPI::getEncodingProfiles(string contentType, int64_t encodingProfileKey, string label, bool cacheAllowed)
 {
-	string api = "getEncodingProfilesSets";
+	string api = "getEncodingProfiles";
+	ApiMetrics::Call call(_metrics, api);
 
-	if (!_loginSuccessful)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
 		string errorMessage = "login API was not called yet";
 		SPDLOG_ERROR(errorMessage);
@@ -477,9 +915,7 @@ vector<CatraMMSAPI::EncodingProfilesSet> CatraMMSAPI::getEncodingProfilesSets(st
 
 	try
 	{
-		string url = std::format("{}://{}:{}/catramms/1.0.1/encodingProfilesSets/{}", _apiProtocol, _apiHostname, _apiPort, contentType);
-		char queryChar = '?';
-		url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+		string url = encodingProfilesURL(*session, contentType, encodingProfileKey, label, cacheAllowed);
 
 		LOG_INFO(
 			"httpGetJson"
@@ -487,28 +923,78 @@ vector<CatraMMSAPI::EncodingProfilesSet> CatraMMSAPI::getEncodingProfilesSets(st
 			", _outputToBeCompressed: {}",
 			url, _outputToBeCompressed
 		);
-		vector<string> otherHeaders;
-		if (_outputToBeCompressed)
-			otherHeaders.emplace_back("X-ResponseBodyCompressed: true");
-		json mmsInfoRoot = CurlWrapper::httpGetJson(
-			url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(std::format("{}", userProfile.userKey), currentWorkspaceDetails.apiKey),
-			otherHeaders, "", _apiMaxRetries, 15, _outputToBeCompressed,
-			_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-			_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-			_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-			_httpSSLVersion, _httpVerbose
+
+		return any_cast<vector<EncodingProfile>>(
+			cachedGetJson(*session, api, url, _encodingProfilesCacheTTLInSeconds, cacheAllowed, parseEncodingProfiles)
+		);
+	}
+	catch (exception &e)
+	{
+		string errorMessage = std::format(
+			"{} failed"
+			", exception: {}",
+			api, e.what()
 		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw;
+	}
+}
+
+future<vector<CatraMMSAPI::EncodingProfile>>
+CatraMMSAPI::getEncodingProfilesAsync(string contentType, int64_t encodingProfileKey, string label, bool cacheAllowed)
+{
+	string api = "getEncodingProfilesAsync";
+
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
+	{
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
 
-		json responseRoot = JsonPath(&mmsInfoRoot)["response"].as<json>();
-		json encodingProfilesSetsRoot = JsonPath(&responseRoot)["encodingProfilesSets"].as<json>(json::array());
+		throw runtime_error(errorMessage);
+	}
+
+	string url = encodingProfilesURL(*session, contentType, encodingProfileKey, label, cacheAllowed);
+
+	LOG_INFO(
+		"httpGetJson"
+		", url: {}"
+		", _outputToBeCompressed: {}",
+		url, _outputToBeCompressed
+	);
+
+	return cachedGetJsonAsync<vector<EncodingProfile>>(*session, api, url, _encodingProfilesCacheTTLInSeconds, cacheAllowed, parseEncodingProfiles);
+}
+
+vector<CatraMMSAPI::EncodingProfilesSet> CatraMMSAPI::getEncodingProfilesSets(string contentType, bool cacheAllowed)
+{
+	string api = "getEncodingProfilesSets";
+	ApiMetrics::Call call(_metrics, api);
+
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
+	{
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
 
-		vector<EncodingProfilesSet> encodingProfilesSets;
+	try
+	{
+		string url = encodingProfilesSetsURL(*session, contentType, cacheAllowed);
 
-		bool deep = true;
-		for (auto &[keyRoot, valRoot] : encodingProfilesSetsRoot.items())
-			encodingProfilesSets.push_back(fillEncodingProfilesSet(valRoot, deep));
+		LOG_INFO(
+			"httpGetJson"
+			", url: {}"
+			", _outputToBeCompressed: {}",
+			url, _outputToBeCompressed
+		);
 
-		return encodingProfilesSets;
+		return any_cast<vector<EncodingProfilesSet>>(
+			cachedGetJson(*session, api, url, _encodingProfilesSetsCacheTTLInSeconds, cacheAllowed, parseEncodingProfilesSets)
+		);
 	}
 	catch (exception &e)
 	{
@@ -523,11 +1009,40 @@ vector<CatraMMSAPI::EncodingProfilesSet> CatraMMSAPI::getEncodingProfilesSets(st
 	}
 }
 
+future<vector<CatraMMSAPI::EncodingProfilesSet>> CatraMMSAPI::getEncodingProfilesSetsAsync(string contentType, bool cacheAllowed)
+{
+	string api = "getEncodingProfilesSetsAsync";
+
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
+	{
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	string url = encodingProfilesSetsURL(*session, contentType, cacheAllowed);
+
+	LOG_INFO(
+		"httpGetJson"
+		", url: {}"
+		", _outputToBeCompressed: {}",
+		url, _outputToBeCompressed
+	);
+
+	return cachedGetJsonAsync<vector<EncodingProfilesSet>>(
+		*session, api, url, _encodingProfilesSetsCacheTTLInSeconds, cacheAllowed, parseEncodingProfilesSets
+	);
+}
+
 vector<CatraMMSAPI::EncodersPool> CatraMMSAPI::getEncodersPool(bool cacheAllowed)
 {
 	string api = "getEncodersPool";
+	ApiMetrics::Call call(_metrics, api);
 
-	if (!_loginSuccessful)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
 		string errorMessage = "login API was not called yet";
 		SPDLOG_ERROR(errorMessage);
@@ -537,9 +1052,7 @@ vector<CatraMMSAPI::EncodersPool> CatraMMSAPI::getEncodersPool(bool cacheAllowed
 
 	try
 	{
-		string url = std::format("{}://{}:{}/catramms/1.0.1/encodersPool?labelOrder=asc", _apiProtocol, _apiHostname, _apiPort);
-		char queryChar = '?';
-		url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+		string url = encodersPoolURL(*session, cacheAllowed);
 
 		LOG_INFO(
 			"httpGetJson"
@@ -547,28 +1060,8 @@ vector<CatraMMSAPI::EncodersPool> CatraMMSAPI::getEncodersPool(bool cacheAllowed
 			", _outputToBeCompressed: {}",
 			url, _outputToBeCompressed
 		);
-		vector<string> otherHeaders;
-		if (_outputToBeCompressed)
-			otherHeaders.push_back("X-ResponseBodyCompressed: true");
-		json mmsInfoRoot = CurlWrapper::httpGetJson(
-			url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(std::format("{}", userProfile.userKey),
-				currentWorkspaceDetails.apiKey),
-			otherHeaders, "", _apiMaxRetries, 15, _outputToBeCompressed,
-			_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-			_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-			_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-			_httpSSLVersion, _httpVerbose
-		);
-
-		json responseRoot = JsonPath(&mmsInfoRoot)["response"].as<json>();
-		json encodersPoolRoot = JsonPath(&responseRoot)["encodersPool"].as<json>(json::array());
 
-		vector<EncodersPool> encodersPool;
-
-		for (auto &[keyRoot, valRoot] : encodersPoolRoot.items())
-			encodersPool.push_back(fillEncodersPool(valRoot));
-
-		return encodersPool;
+		return any_cast<vector<EncodersPool>>(cachedGetJson(*session, api, url, _encodersPoolCacheTTLInSeconds, cacheAllowed, parseEncodersPool));
 	}
 	catch (exception &e)
 	{
@@ -583,11 +1076,49 @@ vector<CatraMMSAPI::EncodersPool> CatraMMSAPI::getEncodersPool(bool cacheAllowed
 	}
 }
 
+shared_ptr<EncoderPoolMonitor> CatraMMSAPI::encoderPoolMonitor()
+{
+	lock_guard<mutex> locker(_encoderPoolMonitorMutex);
+
+	// in case the first refresh fails (i.e.: login not called yet) it is tried again by the next call
+	if (!_encoderPoolMonitor)
+		_encoderPoolMonitor = make_shared<EncoderPoolMonitor>(this, chrono::seconds(_encoderPoolMonitorRefreshIntervalInSeconds));
+
+	return _encoderPoolMonitor;
+}
+
+future<vector<CatraMMSAPI::EncodersPool>> CatraMMSAPI::getEncodersPoolAsync(bool cacheAllowed)
+{
+	string api = "getEncodersPoolAsync";
+
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
+	{
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	string url = encodersPoolURL(*session, cacheAllowed);
+
+	LOG_INFO(
+		"httpGetJson"
+		", url: {}"
+		", _outputToBeCompressed: {}",
+		url, _outputToBeCompressed
+	);
+
+	return cachedGetJsonAsync<vector<EncodersPool>>(*session, api, url, _encodersPoolCacheTTLInSeconds, cacheAllowed, parseEncodersPool);
+}
+
 vector<CatraMMSAPI::RTMPChannelConf> CatraMMSAPI::getRTMPChannelConf(string label, bool labelLike, string type, bool cacheAllowed)
 {
 	string api = "getRTMPChannelConf";
+	ApiMetrics::Call call(_metrics, api);
 
-	if (!_loginSuccessful)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
 		string errorMessage = "login API was not called yet";
 		SPDLOG_ERROR(errorMessage);
@@ -597,18 +1128,7 @@ vector<CatraMMSAPI::RTMPChannelConf> CatraMMSAPI::getRTMPChannelConf(string labe
 
 	try
 	{
-		string url = std::format("{}://{}:{}/catramms/1.0.1/conf/cdn/rtmp/channel", _apiProtocol, _apiHostname, _apiPort);
-		char queryChar = '?';
-		if (!label.empty())
-		{
-			url += std::format("{}label={}", queryChar, CurlWrapper::escape(label));
-			queryChar = '&';
-		}
-		url += std::format("{}labelLike={}", queryChar, labelLike);
-		queryChar = '&';
-		if (!type.empty())
-			url += std::format("{}type={}", queryChar, CurlWrapper::escape(label));
-		url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+		string url = rtmpChannelConfURL(*session, label, labelLike, type, cacheAllowed);
 
 		LOG_INFO(
 			"httpGetJson"
@@ -616,27 +1136,10 @@ vector<CatraMMSAPI::RTMPChannelConf> CatraMMSAPI::getRTMPChannelConf(string labe
 			", _outputToBeCompressed: {}",
 			url, _outputToBeCompressed
 		);
-		vector<string> otherHeaders;
-		if (_outputToBeCompressed)
-			otherHeaders.push_back("X-ResponseBodyCompressed: true");
-		json mmsInfoRoot = CurlWrapper::httpGetJson(
-			url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(std::format("{}", userProfile.userKey), currentWorkspaceDetails.apiKey),
-			otherHeaders, "", _apiMaxRetries, 15, _outputToBeCompressed,
-			_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-			_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-			_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-			_httpSSLVersion, _httpVerbose
-		);
-
-		json responseRoot = JsonPath(&mmsInfoRoot)["response"].as<json>();
-		json rtmpChannelConfRoot = JsonPath(&responseRoot)["rtmpChannelConf"].as<json>(json::array());
-
-		vector<RTMPChannelConf> rtmpChannelConfs;
-
-		for (auto &[keyRoot, valRoot] : rtmpChannelConfRoot.items())
-			rtmpChannelConfs.push_back(fillRTMPChannelConf(valRoot));
 
-		return rtmpChannelConfs;
+		return any_cast<vector<RTMPChannelConf>>(
+			cachedGetJson(*session, api, url, _rtmpChannelConfCacheTTLInSeconds, cacheAllowed, parseRTMPChannelConfs)
+		);
 	}
 	catch (exception &e)
 	{
@@ -651,11 +1154,38 @@ vector<CatraMMSAPI::RTMPChannelConf> CatraMMSAPI::getRTMPChannelConf(string labe
 	}
 }
 
-vector<CatraMMSAPI::SRTChannelConf> CatraMMSAPI::getSRTChannelConf(const string& label, bool labelLike, const string& type, bool cacheAllowed)
+future<vector<CatraMMSAPI::RTMPChannelConf>> CatraMMSAPI::getRTMPChannelConfAsync(string label, bool labelLike, string type, bool cacheAllowed)
+{
+	string api = "getRTMPChannelConfAsync";
+
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
+	{
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	string url = rtmpChannelConfURL(*session, label, labelLike, type, cacheAllowed);
+
+	LOG_INFO(
+		"httpGetJson"
+		", url: {}"
+		", _outputToBeCompressed: {}",
+		url, _outputToBeCompressed
+	);
+
+	return cachedGetJsonAsync<vector<RTMPChannelConf>>(*session, api, url, _rtmpChannelConfCacheTTLInSeconds, cacheAllowed, parseRTMPChannelConfs);
+}
+
+vector<CatraMMSAPI::SRTChannelConf> CatraMMSAPI::getSRTChannelConf(const string &label, bool labelLike, const string &type, bool cacheAllowed)
 {
 	string api = "getSRTChannelConf";
+	ApiMetrics::Call call(_metrics, api);
 
-	if (!_loginSuccessful)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
 		string errorMessage = "login API was not called yet";
 		SPDLOG_ERROR(errorMessage);
@@ -665,18 +1195,7 @@ vector<CatraMMSAPI::SRTChannelConf> CatraMMSAPI::getSRTChannelConf(const string&
 
 	try
 	{
-		string url = std::format("{}://{}:{}/catramms/1.0.1/conf/cdn/srt/channel", _apiProtocol, _apiHostname, _apiPort);
-		char queryChar = '?';
-		if (!label.empty())
-		{
-			url += std::format("{}label={}", queryChar, CurlWrapper::escape(label));
-			queryChar = '&';
-		}
-		url += std::format("{}labelLike={}", queryChar, labelLike);
-		queryChar = '&';
-		if (!type.empty())
-			url += std::format("{}type={}", queryChar, CurlWrapper::escape(label));
-		url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+		string url = srtChannelConfURL(*session, label, labelLike, type, cacheAllowed);
 
 		LOG_INFO(
 			"httpGetJson"
@@ -684,27 +1203,10 @@ vector<CatraMMSAPI::SRTChannelConf> CatraMMSAPI::getSRTChannelConf(const string&
 			", _outputToBeCompressed: {}",
 			url, _outputToBeCompressed
 		);
-		vector<string> otherHeaders;
-		if (_outputToBeCompressed)
-			otherHeaders.emplace_back("X-ResponseBodyCompressed: true");
-		json mmsInfoRoot = CurlWrapper::httpGetJson(
-			url, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(std::format("{}", userProfile.userKey), currentWorkspaceDetails.apiKey),
-			otherHeaders, "", _apiMaxRetries, 15, _outputToBeCompressed,
-			_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-			_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-			_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-			_httpSSLVersion, _httpVerbose
-		);
-
-		json responseRoot = JsonPath(&mmsInfoRoot)["response"].as<json>();
-		json srtChannelConfRoot = JsonPath(&responseRoot)["srtChannelConf"].as<json>(json::array());
 
-		vector<SRTChannelConf> srtChannelConfs;
-
-		for (auto &[keyRoot, valRoot] : srtChannelConfRoot.items())
-			srtChannelConfs.push_back(fillSRTChannelConf(valRoot));
-
-		return srtChannelConfs;
+		return any_cast<vector<SRTChannelConf>>(
+			cachedGetJson(*session, api, url, _srtChannelConfCacheTTLInSeconds, cacheAllowed, parseSRTChannelConfs)
+		);
 	}
 	catch (exception &e)
 	{
@@ -719,7 +1221,33 @@ vector<CatraMMSAPI::SRTChannelConf> CatraMMSAPI::getSRTChannelConf(const string&
 	}
 }
 
-pair<vector<CatraMMSAPI::Stream>, int16_t> CatraMMSAPI::getStreams(
+future<vector<CatraMMSAPI::SRTChannelConf>>
+CatraMMSAPI::getSRTChannelConfAsync(const string &label, bool labelLike, const string &type, bool cacheAllowed)
+{
+	string api = "getSRTChannelConfAsync";
+
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
+	{
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	string url = srtChannelConfURL(*session, label, labelLike, type, cacheAllowed);
+
+	LOG_INFO(
+		"httpGetJson"
+		", url: {}"
+		", _outputToBeCompressed: {}",
+		url, _outputToBeCompressed
+	);
+
+	return cachedGetJsonAsync<vector<SRTChannelConf>>(*session, api, url, _srtChannelConfCacheTTLInSeconds, cacheAllowed, parseSRTChannelConfs);
+}
+
+pair<vector<CatraMMSAPI::Stream>, int64_t> CatraMMSAPI::getStreams(
 	optional<int32_t> startIndex, optional<int32_t> pageSize,
 	optional<int64_t> confKey,
 	optional<string> label, optional<bool> labelLike,
@@ -730,8 +1258,10 @@ pair<vector<CatraMMSAPI::Stream>, int16_t> CatraMMSAPI::getStreams(
 	const string& labelOrder, bool cacheAllowed)
 {
 	string api = "getStream";
+	ApiMetrics::Call call(_metrics, api);
 
-	if (!_loginSuccessful)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
 		string errorMessage = "login API was not called yet";
 		SPDLOG_ERROR(errorMessage);
@@ -741,65 +1271,9 @@ pair<vector<CatraMMSAPI::Stream>, int16_t> CatraMMSAPI::getStreams(
 
 	try
 	{
-		string apiUrl = std::format("{}://{}:{}/catramms/1.0.1/conf/stream", _apiProtocol, _apiHostname, _apiPort);
-		if (confKey)
-			apiUrl += std::format("/{}", *confKey);
-		char queryChar = '?';
-		if (startIndex)
-		{
-			apiUrl += std::format("{}start={}", queryChar, *startIndex);
-			queryChar = '&';
-		}
-		if (pageSize)
-		{
-			apiUrl += std::format("{}rows={}", queryChar, *pageSize);
-			queryChar = '&';
-		}
-		if (label)
-		{
-			apiUrl += std::format("{}label={}", queryChar, CurlWrapper::escape(*label));
-			queryChar = '&';
-		}
-		if (labelLike)
-		{
-			apiUrl += std::format("{}labelLike={}", queryChar, *labelLike);
-			queryChar = '&';
-		}
-		if (url)
-		{
-			apiUrl += std::format("{}url={}", queryChar, CurlWrapper::escape(*url));
-			queryChar = '&';
-		}
-		if (sourceType)
-		{
-			apiUrl += std::format("{}sourceType={}", queryChar, *sourceType);
-			queryChar = '&';
-		}
-		if (type)
-		{
-			apiUrl += std::format("{}type={}", queryChar, CurlWrapper::escape(*type));
-			queryChar = '&';
-		}
-		if (name)
-		{
-			apiUrl += std::format("{}name={}", queryChar, CurlWrapper::escape(*name));
-			queryChar = '&';
-		}
-		if (region)
-		{
-			apiUrl += std::format("{}region={}", queryChar, CurlWrapper::escape(*region));
-			queryChar = '&';
-		}
-		if (country)
-		{
-			apiUrl += std::format("{}country={}", queryChar, CurlWrapper::escape(*country));
-			queryChar = '&';
-		}
-		{
-			apiUrl += std::format("{}labelOrder={}", queryChar, labelOrder);
-			queryChar = '&';
-		}
-		apiUrl += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+		string apiUrl = streamsURL(
+			*session, startIndex, pageSize, confKey, label, labelLike, url, sourceType, type, name, region, country, labelOrder, cacheAllowed
+		);
 
 		LOG_INFO(
 			"httpGetJson"
@@ -807,28 +1281,10 @@ pair<vector<CatraMMSAPI::Stream>, int16_t> CatraMMSAPI::getStreams(
 			", _outputToBeCompressed: {}",
 			apiUrl, _outputToBeCompressed
 		);
-		vector<string> otherHeaders;
-		if (_outputToBeCompressed)
-			otherHeaders.emplace_back("X-ResponseBodyCompressed: true");
-		json mmsInfoRoot = CurlWrapper::httpGetJson(
-			apiUrl, _apiTimeoutInSeconds, CurlWrapper::basicAuthorization(std::format("{}", userProfile.userKey), currentWorkspaceDetails.apiKey),
-			otherHeaders, "", _apiMaxRetries, 15, _outputToBeCompressed,
-			_proxyURL.empty() ? std::nullopt : std::optional(_proxyURL),
-			_proxyUsername.empty() ? std::nullopt : std::optional(_proxyUsername),
-			_proxyPassword.empty() ? std::nullopt : std::optional(_proxyPassword),
-			_httpSSLVersion, _httpVerbose
-		);
-
-		json responseRoot = JsonPath(&mmsInfoRoot)["response"].as<json>();
-		auto numFound = JsonPath(&responseRoot)["numFound"].as<int16_t>();
-		auto streamsRoot = JsonPath(&responseRoot)["streams"].as<json>(json::array());
-
-		vector<Stream> streams;
-
-		for (auto &[keyRoot, valRoot] : streamsRoot.items())
-			streams.push_back(fillStream(valRoot));
+		any streams;
+		streamedGet(*session, api, apiUrl, "", parseStreams, streams);
 
-		return make_pair(streams, numFound);
+		return any_cast<pair<vector<Stream>, int64_t>>(std::move(streams));
 	}
 	catch (exception &e)
 	{
@@ -843,409 +1299,1786 @@ pair<vector<CatraMMSAPI::Stream>, int16_t> CatraMMSAPI::getStreams(
 	}
 }
 
-CatraMMSAPI::UserProfile CatraMMSAPI::fillUserProfile(const json& userProfileRoot)
+future<pair<vector<CatraMMSAPI::Stream>, int64_t>> CatraMMSAPI::getStreamsAsync(
+	optional<int32_t> startIndex, optional<int32_t> pageSize, optional<int64_t> confKey, optional<string> label, optional<bool> labelLike,
+	optional<string> url, optional<string> sourceType, optional<string> type, optional<string> name, optional<string> region, optional<string> country,
+	const string &labelOrder, bool cacheAllowed
+)
 {
-	try
-	{
-		UserProfile userProfile;
+	string api = "getStreamAsync";
 
-		userProfile.userKey = JsonPath(&userProfileRoot)["userKey"].as<int64_t>(-1);
-		userProfile.ldapEnabled = JsonPath(&userProfileRoot)["ldapEnabled"].as<bool>(false);
-		userProfile.name = JsonPath(&userProfileRoot)["name"].as<string>();
-		userProfile.country = JsonPath(&userProfileRoot)["country"].as<string>();
-		userProfile.timezone = JsonPath(&userProfileRoot)["timezone"].as<string>();
-		userProfile.email = JsonPath(&userProfileRoot)["email"].as<string>();
-		userProfile.creationDate = Datetime::parseStringToUtcInSecs(JsonPath(&userProfileRoot)["creationDate"].as<string>());
-		userProfile.insolvent = JsonPath(&userProfileRoot)["insolvent"].as<bool>(false);
-		userProfile.expirationDate = Datetime::parseStringToUtcInSecs(JsonPath(&userProfileRoot)["expirationDate"].as<string>());
-
-		return userProfile;
-	}
-	catch (exception &e)
+	shared_ptr<const Session> session = _session.load();
+	if (!session)
 	{
-		SPDLOG_ERROR(
-			"fillUserProfile failed"
-			", exception: {}",
-			e.what()
-		);
-		throw;
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
 	}
+
+	string apiUrl =
+		streamsURL(*session, startIndex, pageSize, confKey, label, labelLike, url, sourceType, type, name, region, country, labelOrder, cacheAllowed);
+
+	LOG_INFO(
+		"httpGetJson"
+		", apiUrl: {}"
+		", _outputToBeCompressed: {}",
+		apiUrl, _outputToBeCompressed
+	);
+
+	// streams are not cached
+	return cachedGetJsonAsync<pair<vector<Stream>, int64_t>>(*session, api, apiUrl, 0, cacheAllowed, parseStreams);
 }
 
-CatraMMSAPI::WorkspaceDetails CatraMMSAPI::fillWorkspaceDetails(const json& workspacedetailsRoot)
+CatraMMSAPI::StreamsRange CatraMMSAPI::getAllStreams(
+	int32_t pageSize, optional<int64_t> confKey, optional<string> label, optional<bool> labelLike, optional<string> url, optional<string> sourceType,
+	optional<string> type, optional<string> name, optional<string> region, optional<string> country, const string &labelOrder
+)
 {
-	try
+	if (!_session.load())
 	{
-		WorkspaceDetails workspaceDetails;
-
-		workspaceDetails.workspaceKey = JsonPath(&workspacedetailsRoot)["workspaceKey"].as<int64_t>(-1);
-		workspaceDetails.enabled = JsonPath(&workspacedetailsRoot)["enabled"].as<bool>(false);
-		workspaceDetails.name = JsonPath(&workspacedetailsRoot)["workspaceName"].as<string>();
-		workspaceDetails.maxEncodingPriority = JsonPath(&workspacedetailsRoot)["maxEncodingPriority"].as<string>();
-		workspaceDetails.encodingPeriod = JsonPath(&workspacedetailsRoot)["encodingPeriod"].as<string>();
-		workspaceDetails.maxIngestionsNumber = JsonPath(&workspacedetailsRoot)["maxIngestionsNumber"].as<int64_t>(-1);
-		workspaceDetails.usageInMB = JsonPath(&workspacedetailsRoot)["workSpaceUsageInMB"].as<int64_t>(-1);
-		workspaceDetails.languageCode = JsonPath(&workspacedetailsRoot)["languageCode"].as<string>();
-		workspaceDetails.timezone = JsonPath(&workspacedetailsRoot)["timezone"].as<string>();
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
 
-		workspaceDetails.preferences = nullptr;
-		if (!JsonPath(&workspacedetailsRoot)["preferences"].as<string>("").empty())
-		{
-			try
-			{
-				workspaceDetails.preferences = JSONUtils::toJson<json>(JsonPath(&workspacedetailsRoot)["preferences"].as<string>());
-			}
-			catch (exception &e)
-			{
-				SPDLOG_ERROR("Wrong workspaceDetails.preferences format: {}", JsonPath(&workspacedetailsRoot)["preferences"].as<string>());
-			}
-		}
+		throw runtime_error(errorMessage);
+	}
 
-		workspaceDetails.creationDate = Datetime::parseStringToUtcInSecs(JsonPath(&workspacedetailsRoot)["creationDate"].as<string>());
-		workspaceDetails.workspaceOwnerUserKey = JsonPath(&workspacedetailsRoot)["workspaceOwnerUserKey"].as<int64_t>(-1);
-		workspaceDetails.workspaceOwnerUserName = JsonPath(&workspacedetailsRoot)["workspaceOwnerUserName"].as<string>();
-		if (JSONUtils::isPresent(workspacedetailsRoot, "userAPIKey"))
-		{
-			json userAPIKeyRoot = JsonPath(&workspacedetailsRoot)["userAPIKey"].as<json>();
-
-			workspaceDetails.apiKey = JsonPath(&userAPIKeyRoot)["apiKey"].as<string>();
-			workspaceDetails.owner = JsonPath(&userAPIKeyRoot)["owner"].as<bool>(false);
-			workspaceDetails.defaultWorkspace = JsonPath(&userAPIKeyRoot)["default"].as<bool>(false);
-			workspaceDetails.expirationDate = Datetime::parseStringToUtcInSecs(JsonPath(&userAPIKeyRoot)["expirationDate"].as<string>());
-			workspaceDetails.admin = JsonPath(&userAPIKeyRoot)["admin"].as<bool>(false);
-			workspaceDetails.createRemoveWorkspace = JsonPath(&userAPIKeyRoot)["createRemoveWorkspace"].as<bool>(false);
-			workspaceDetails.ingestWorkflow = JsonPath(&userAPIKeyRoot)["ingestWorkflow"].as<bool>(false);
-			workspaceDetails.createProfiles = JsonPath(&userAPIKeyRoot)["createProfiles"].as<bool>(false);
-			workspaceDetails.deliveryAuthorization = JsonPath(&userAPIKeyRoot)["deliveryAuthorization"].as<bool>(false);
-			workspaceDetails.shareWorkspace = JsonPath(&userAPIKeyRoot)["shareWorkspace"].as<bool>(false);
-			workspaceDetails.editMedia = JsonPath(&userAPIKeyRoot)["editMedia"].as<bool>(false);
-			workspaceDetails.editConfiguration = JsonPath(&userAPIKeyRoot)["editConfiguration"].as<bool>(false);
-			workspaceDetails.killEncoding = JsonPath(&userAPIKeyRoot)["killEncoding"].as<bool>(false);
-			workspaceDetails.cancelIngestionJob = JsonPath(&userAPIKeyRoot)["cancelIngestionJob"].as<bool>(false);
-			workspaceDetails.editEncodersPool = JsonPath(&userAPIKeyRoot)["editEncodersPool"].as<bool>(false);
-			workspaceDetails.applicationRecorder = JsonPath(&userAPIKeyRoot)["applicationRecorder"].as<bool>(false);
-			workspaceDetails.appUploadMediaContent = JsonPath(&userAPIKeyRoot)["appUploadMediaContent"].as<bool>(false);
-			workspaceDetails.appCaptureScreenAndProxy = JsonPath(&userAPIKeyRoot)["appCaptureScreenAndProxy"].as<bool>(false);
-			workspaceDetails.appStreamAndProxy = JsonPath(&userAPIKeyRoot)["appStreamAndProxy"].as<bool>(false);
-		}
-		if (JSONUtils::isPresent(workspacedetailsRoot, "cost"))
-		{
-			json costInfoRoot = JsonPath(&workspacedetailsRoot)["cost"].as<json>();
-
-			workspaceDetails.maxStorageInGB = JsonPath(&costInfoRoot)["maxStorageInGB"].as<int64_t>(-1);
-			workspaceDetails.currentCostForStorage = JsonPath(&costInfoRoot)["currentCostForStorage"].as<int64_t>(-1);
-			workspaceDetails.dedicatedEncoder_power_1 = JsonPath(&costInfoRoot)["dedicatedEncoder_power_1"].as<int64_t>(-1);
-			workspaceDetails.currentCostForDedicatedEncoder_power_1 = JsonPath(&costInfoRoot)["currentCostForDedicatedEncoder_power_1"].as<int64_t>(-1);
-			workspaceDetails.dedicatedEncoder_power_2 = JsonPath(&costInfoRoot)["dedicatedEncoder_power_2"].as<int64_t>(-1);
-			workspaceDetails.currentCostForDedicatedEncoder_power_2 = JsonPath(&costInfoRoot)["currentCostForDedicatedEncoder_power_2"].as<int64_t>(-1);
-			workspaceDetails.dedicatedEncoder_power_3 = JsonPath(&costInfoRoot)["dedicatedEncoder_power_3"].as<int64_t>(-1);
-			workspaceDetails.currentCostForDedicatedEncoder_power_3 = JsonPath(&costInfoRoot)["currentCostForDedicatedEncoder_power_3"].as<int64_t>(-1);
-			workspaceDetails.CDN_type_1 = JsonPath(&costInfoRoot)["CDN_type_1"].as<int64_t>(-1);
-			workspaceDetails.currentCostForCDN_type_1 = JsonPath(&costInfoRoot)["currentCostForCDN_type_1"].as<int64_t>(-1);
-			workspaceDetails.support_type_1 = JsonPath(&costInfoRoot)["support_type_1"].as<bool>(false);
-			workspaceDetails.currentCostForSupport_type_1 = JsonPath(&costInfoRoot)["currentCostForSupport_type_1"].as<int64_t>(-1);
-		}
+	// streams are not cached, every page is requested to the server
+	StreamsRange::PageFetcher pageFetcher =
+		[this, confKey, label, labelLike, url, sourceType, type, name, region, country, labelOrder](int32_t startIndex, int32_t pageSize)
+	{ return getStreamsAsync(startIndex, pageSize, confKey, label, labelLike, url, sourceType, type, name, region, country, labelOrder, false); };
 
-		return workspaceDetails;
-	}
-	catch (exception &e)
-	{
-		SPDLOG_ERROR(
-			"fillWorkspaceDetails failed"
-			", exception: {}",
-			e.what()
-		);
-		throw;
-	}
+	return {std::move(pageFetcher), pageSize};
 }
 
-CatraMMSAPI::EncodingProfile CatraMMSAPI::fillEncodingProfile(const json& encodingProfileRoot, const bool deep)
+shared_ptr<StreamCatalog> CatraMMSAPI::streamCatalog()
 {
-	try
-	{
-		EncodingProfile encodingProfile;
+	lock_guard<mutex> locker(_streamCatalogMutex);
 
-		encodingProfile.global = JsonPath(&encodingProfileRoot)["global"].as<bool>(false);
-		encodingProfile.encodingProfileKey = JsonPath(&encodingProfileRoot)["encodingProfileKey"].as<int64_t>(-1);
-		encodingProfile.label = JsonPath(&encodingProfileRoot)["label"].as<string>();
-		encodingProfile.contentType = JsonPath(&encodingProfileRoot)["contentType"].as<string>();
+	// in case the first sync fails (i.e.: login not called yet) it is tried again by the next call
+	if (!_streamCatalog)
+		_streamCatalog = make_shared<StreamCatalog>(this, chrono::seconds(_streamCatalogRefreshIntervalInSeconds), _streamCatalogPageSize);
 
-		encodingProfile.encodingProfileRoot = JsonPath(&encodingProfileRoot)["profile"].as<json>();
-		encodingProfile.fileFormat = JsonPath(&encodingProfile.encodingProfileRoot)["fileFormat"].as<string>();
-		encodingProfile.description = JsonPath(&encodingProfile.encodingProfileRoot)["description"].as<string>();
-		if (deep)
-		{
-			if (encodingProfile.contentType == "video")
-			{
-				json videoInfoRoot = JsonPath(&encodingProfile.encodingProfileRoot)["video"].as<json>();
-				encodingProfile.videoDetails.codec = JsonPath(&videoInfoRoot)["codec"].as<string>();
-				encodingProfile.videoDetails.profile = JsonPath(&videoInfoRoot)["profile"].as<string>();
-				encodingProfile.videoDetails.twoPasses = JsonPath(&videoInfoRoot)["twoPasses"].as<bool>(false);
-				encodingProfile.videoDetails.otherOutputParameters = JsonPath(&videoInfoRoot)["otherOutputParameters"].as<string>();
-				encodingProfile.videoDetails.frameRate = JsonPath(&videoInfoRoot)["frameRate"].as<int32_t>(-1);
-				encodingProfile.videoDetails.keyFrameIntervalInSeconds = JsonPath(&videoInfoRoot)["keyFrameIntervalInSeconds"].as<int32_t>(-1);
-				{
-					json bitRatesRoot = JsonPath(&videoInfoRoot)["bitRates"].as<json>(json::array());
-					for (auto &[keyRoot, valRoot] : bitRatesRoot.items())
-					{
-						VideoBitRate videoBitRate;
+	return _streamCatalog;
+}
 
-						videoBitRate.width = JsonPath(&valRoot)["width"].as<int32_t>(-1);
-						videoBitRate.height = JsonPath(&valRoot)["height"].as<int32_t>(-1);
-						videoBitRate.kBitRate = JsonPath(&valRoot)["kBitRate"].as<int32_t>(-1);
-						videoBitRate.forceOriginalAspectRatio = JsonPath(&valRoot)["forceOriginalAspectRatio"].as<int32_t>(-1);
-						videoBitRate.pad = JsonPath(&valRoot)["pad"].as<int32_t>(-1);
-						videoBitRate.kMaxRate = JsonPath(&valRoot)["kMaxRate"].as<int32_t>(-1);
-						videoBitRate.kBufferSize = JsonPath(&valRoot)["kBufferSize"].as<int32_t>(-1);
+CatraMMSAPI::StreamsRange::StreamsRange(PageFetcher pageFetcher, int32_t pageSize)
+	: _pageFetcher(std::move(pageFetcher)), _pageSize(pageSize > 0 ? pageSize : 100), _started(false), _total(0), _nextStartIndex(0), _pageIndex(0)
+{
+}
 
-						encodingProfile.videoDetails.videoBitRates.push_back(videoBitRate);
-					}
-				}
+CatraMMSAPI::StreamsRange::Iterator CatraMMSAPI::StreamsRange::begin()
+{
+	start();
 
-				json audioInfoRoot = JsonPath(&encodingProfile.encodingProfileRoot)["audio"].as<json>();
-				encodingProfile.audioDetails.codec = JsonPath(&audioInfoRoot)["codec"].as<string>();
-				encodingProfile.audioDetails.otherOutputParameters = JsonPath(&audioInfoRoot)["otherOutputParameters"].as<string>();
-				encodingProfile.audioDetails.channelsNumber = JsonPath(&audioInfoRoot)["channelsNumber"].as<int32_t>(-1);
-				encodingProfile.audioDetails.sampleRate = JsonPath(&audioInfoRoot)["sampleRate"].as<int32_t>(-1);
-				{
-					json bitRatesRoot = JsonPath(&audioInfoRoot)["bitRates"].as<json>(json::array());
-					for (auto &[keyRoot, valRoot] : bitRatesRoot.items())
-						encodingProfile.audioDetails.kBitRates.push_back(JsonPath(&valRoot)["kBitRate"].as<int32_t>(-1));
-				}
+	return Iterator(this);
+}
+
+int64_t CatraMMSAPI::StreamsRange::total()
+{
+	start();
+
+	return _total;
+}
+
+void CatraMMSAPI::StreamsRange::start()
+{
+	if (_started)
+		return;
+	_started = true;
+
+	fetchNextPage();
+	loadNextPage();
+}
+
+void CatraMMSAPI::StreamsRange::fetchNextPage()
+{
+	_nextPage = _pageFetcher(static_cast<int32_t>(_nextStartIndex), _pageSize);
+	_nextStartIndex += _pageSize;
+}
+
+void CatraMMSAPI::StreamsRange::loadNextPage()
+{
+	_page.clear();
+	_pageIndex = 0;
+	if (!_nextPage.valid())
+		return;
+
+	auto [streams, total] = _nextPage.get();
+	_total = total;
+	_page = std::move(streams);
+
+	// prefetch, the request goes on while the caller iterates this page
+	if (!_page.empty() && _nextStartIndex < _total)
+		fetchNextPage();
+}
+
+void CatraMMSAPI::StreamsRange::next()
+{
+	if (++_pageIndex < _page.size())
+		return;
+
+	loadNextPage();
+}
+
+string CatraMMSAPI::encodingProfilesURL(
+	const Session &session, const string &contentType, int64_t encodingProfileKey, const string &label, bool cacheAllowed
+) const
+{
+	string url = std::format("{}/encodingProfiles/{}", session.apiURL, contentType);
+	if (encodingProfileKey != -1)
+		url += std::format("/{}", encodingProfileKey);
+	char queryChar = '?';
+	if (!label.empty())
+	{
+		url += std::format("{}label={}", queryChar, CurlWrapper::escape(label));
+		queryChar = '&';
+	}
+	url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+
+	return url;
+}
+
+string CatraMMSAPI::encodingProfilesSetsURL(const Session &session, const string &contentType, bool cacheAllowed) const
+{
+	string url = std::format("{}/encodingProfilesSets/{}", session.apiURL, contentType);
+	char queryChar = '?';
+	url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+
+	return url;
+}
+
+string CatraMMSAPI::encodersPoolURL(const Session &session, bool cacheAllowed) const
+{
+	string url = std::format("{}/encodersPool?labelOrder=asc", session.apiURL);
+	char queryChar = '&';
+	url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+
+	return url;
+}
+
+string CatraMMSAPI::rtmpChannelConfURL(const Session &session, const string &label, bool labelLike, const string &type, bool cacheAllowed) const
+{
+	string url = std::format("{}/conf/cdn/rtmp/channel", session.apiURL);
+	char queryChar = '?';
+	if (!label.empty())
+	{
+		url += std::format("{}label={}", queryChar, CurlWrapper::escape(label));
+		queryChar = '&';
+	}
+	url += std::format("{}labelLike={}", queryChar, labelLike);
+	queryChar = '&';
+	if (!type.empty())
+		url += std::format("{}type={}", queryChar, CurlWrapper::escape(type));
+	url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+
+	return url;
+}
+
+string CatraMMSAPI::srtChannelConfURL(const Session &session, const string &label, bool labelLike, const string &type, bool cacheAllowed) const
+{
+	string url = std::format("{}/conf/cdn/srt/channel", session.apiURL);
+	char queryChar = '?';
+	if (!label.empty())
+	{
+		url += std::format("{}label={}", queryChar, CurlWrapper::escape(label));
+		queryChar = '&';
+	}
+	url += std::format("{}labelLike={}", queryChar, labelLike);
+	queryChar = '&';
+	if (!type.empty())
+		url += std::format("{}type={}", queryChar, CurlWrapper::escape(type));
+	url += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+
+	return url;
+}
+
+string CatraMMSAPI::streamsURL(
+	const Session &session, const optional<int32_t> &startIndex, const optional<int32_t> &pageSize, const optional<int64_t> &confKey,
+	const optional<string> &label, const optional<bool> &labelLike, const optional<string> &url, const optional<string> &sourceType,
+	const optional<string> &type, const optional<string> &name, const optional<string> &region, const optional<string> &country,
+	const string &labelOrder, bool cacheAllowed
+) const
+{
+	string apiUrl = std::format("{}/conf/stream", session.apiURL);
+	if (confKey)
+		apiUrl += std::format("/{}", *confKey);
+	char queryChar = '?';
+	if (startIndex)
+	{
+		apiUrl += std::format("{}start={}", queryChar, *startIndex);
+		queryChar = '&';
+	}
+	if (pageSize)
+	{
+		apiUrl += std::format("{}rows={}", queryChar, *pageSize);
+		queryChar = '&';
+	}
+	if (label)
+	{
+		apiUrl += std::format("{}label={}", queryChar, CurlWrapper::escape(*label));
+		queryChar = '&';
+	}
+	if (labelLike)
+	{
+		apiUrl += std::format("{}labelLike={}", queryChar, *labelLike);
+		queryChar = '&';
+	}
+	if (url)
+	{
+		apiUrl += std::format("{}url={}", queryChar, CurlWrapper::escape(*url));
+		queryChar = '&';
+	}
+	if (sourceType)
+	{
+		apiUrl += std::format("{}sourceType={}", queryChar, *sourceType);
+		queryChar = '&';
+	}
+	if (type)
+	{
+		apiUrl += std::format("{}type={}", queryChar, CurlWrapper::escape(*type));
+		queryChar = '&';
+	}
+	if (name)
+	{
+		apiUrl += std::format("{}name={}", queryChar, CurlWrapper::escape(*name));
+		queryChar = '&';
+	}
+	if (region)
+	{
+		apiUrl += std::format("{}region={}", queryChar, CurlWrapper::escape(*region));
+		queryChar = '&';
+	}
+	if (country)
+	{
+		apiUrl += std::format("{}country={}", queryChar, CurlWrapper::escape(*country));
+		queryChar = '&';
+	}
+	{
+		apiUrl += std::format("{}labelOrder={}", queryChar, labelOrder);
+		queryChar = '&';
+	}
+	apiUrl += std::format("{}should_bypass_cache={}", queryChar, cacheAllowed);
+
+	return apiUrl;
+}
+
+void CatraMMSAPI::startClientIPAddressLookup()
+{
+	LOG_INFO(
+		"clientIPAddress lookup"
+		", url: {}"
+		", lookupTimeoutInSeconds: {}",
+		_clientIPAddressLookupURL, _clientIPAddressLookupTimeoutInSeconds
+	);
+
+	auto promise = make_shared<std::promise<string>>();
+	_clientIPAddressLookup = promise->get_future().share();
+
+	CurlConnectionPool::HttpRequest request{_clientIPAddressLookupURL, _clientIPAddressLookupTimeoutInSeconds, "", {}, nullopt, "", false, false, ""};
+	eventLoop()->submit(
+		std::move(request), 0,
+		[url = _clientIPAddressLookupURL, promise](CurlConnectionPool::HttpResponse &&response, exception_ptr error)
+		{
+			string clientIPAddress;
+			try
+			{
+				if (error)
+					rethrow_exception(error);
+
+				json clientIPRoot = JSONUtils::toJson<json>(response.body);
+				clientIPAddress = JsonPath(&clientIPRoot)["ip"].as<string>();
+				LOG_INFO(
+					"clientIPAddress lookup"
+					", url: {}"
+					", clientIPAddress: {}",
+					url, clientIPAddress
+				);
 			}
-			else if (encodingProfile.contentType == "audio")
+			catch (exception &e)
 			{
-				json audioInfoRoot = JsonPath(&encodingProfile.encodingProfileRoot)["audio"].as<json>();
-				encodingProfile.audioDetails.codec = JsonPath(&audioInfoRoot)["codec"].as<string>();
-				encodingProfile.audioDetails.otherOutputParameters = JsonPath(&audioInfoRoot)["otherOutputParameters"].as<string>();
-				encodingProfile.audioDetails.channelsNumber = JsonPath(&audioInfoRoot)["channelsNumber"].as<int32_t>(-1);
-				encodingProfile.audioDetails.sampleRate = JsonPath(&audioInfoRoot)["sampleRate"].as<int32_t>(-1);
+				// login goes on without remoteClientIPAddress
+				SPDLOG_ERROR(
+					"clientIPAddress lookup failed"
+					", url: {}"
+					", exception: {}",
+					url, e.what()
+				);
+			}
+			promise->set_value(clientIPAddress);
+		}
+	);
+}
+
+string CatraMMSAPI::lookedUpClientIPAddress()
+{
+	if (!_clientIPAddress.empty() || _clientIPAddressLookupURL.empty())
+		return _clientIPAddress;
+
+	// looked up once, the result is used by all the following logins
+	call_once(_clientIPAddressLookupStarted, [this]() { startClientIPAddressLookup(); });
+
+	if (_clientIPAddressLookup.wait_for(chrono::milliseconds(_clientIPAddressLookupDeadlineInMilliSeconds)) != future_status::ready)
+	{
+		LOG_WARN(
+			"clientIPAddress lookup not completed yet, login goes on without it"
+			", lookupDeadlineInMilliSeconds: {}",
+			_clientIPAddressLookupDeadlineInMilliSeconds
+		);
+
+		return "";
+	}
+
+	return _clientIPAddressLookup.get();
+}
+
+shared_ptr<const CatraMMSAPI::Session> CatraMMSAPI::session() const { return _session.load(); }
+
+vector<string> CatraMMSAPI::apiOtherHeaders() const
+{
+	vector<string> otherHeaders;
+	if (_outputToBeCompressed)
+		otherHeaders.emplace_back("X-ResponseBodyCompressed: true");
+
+	return otherHeaders;
+}
+
+// SAX targets: the responses are parsed straight into the structs, without building the json DOM
+// (but for the members the structs keep as json)
+struct CatraMMSAPI::SaxTargets
+{
+	// struct whose primitive members are set, one setter for every json key
+	template <typename T> class StructTarget : public JsonSaxReader::Target
+	{
+	  public:
+		using Setters = unordered_map<string, void (*)(T &object, json &value)>;
+
+		explicit StructTarget(const Setters &setters) : _setters(setters), _object(nullptr) {}
+
+		void value(const string &key, json &value) override
+		{
+			if (auto it = _setters.find(key); it != _setters.end())
+				it->second(*_object, value);
+		}
+
+	  protected:
+		const Setters &_setters;
+		T *_object;
+	};
+
+	static time_t asUtcInSecs(json &value)
+	{
+		string date = JsonSaxReader::as<string>(value, "");
+
+		return date.empty() ? 0 : Datetime::parseStringToUtcInSecs(date);
+	}
+
+	class UserAPIKeyTarget : public StructTarget<WorkspaceDetails>
+	{
+	  public:
+		UserAPIKeyTarget() : StructTarget(setters()) {}
+
+		void bind(WorkspaceDetails *workspaceDetails) { _object = workspaceDetails; }
+
+	  private:
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"apiKey", [](WorkspaceDetails &w, json &v) { w.apiKey = JsonSaxReader::as<string>(v, ""); }},
+				{"owner", [](WorkspaceDetails &w, json &v) { w.owner = JsonSaxReader::as<bool>(v, false); }},
+				{"default", [](WorkspaceDetails &w, json &v) { w.defaultWorkspace = JsonSaxReader::as<bool>(v, false); }},
+				{"expirationDate", [](WorkspaceDetails &w, json &v) { w.expirationDate = asUtcInSecs(v); }},
+				{"admin", [](WorkspaceDetails &w, json &v) { w.admin = JsonSaxReader::as<bool>(v, false); }},
+				{"createRemoveWorkspace", [](WorkspaceDetails &w, json &v) { w.createRemoveWorkspace = JsonSaxReader::as<bool>(v, false); }},
+				{"ingestWorkflow", [](WorkspaceDetails &w, json &v) { w.ingestWorkflow = JsonSaxReader::as<bool>(v, false); }},
+				{"createProfiles", [](WorkspaceDetails &w, json &v) { w.createProfiles = JsonSaxReader::as<bool>(v, false); }},
+				{"deliveryAuthorization", [](WorkspaceDetails &w, json &v) { w.deliveryAuthorization = JsonSaxReader::as<bool>(v, false); }},
+				{"shareWorkspace", [](WorkspaceDetails &w, json &v) { w.shareWorkspace = JsonSaxReader::as<bool>(v, false); }},
+				{"editMedia", [](WorkspaceDetails &w, json &v) { w.editMedia = JsonSaxReader::as<bool>(v, false); }},
+				{"editConfiguration", [](WorkspaceDetails &w, json &v) { w.editConfiguration = JsonSaxReader::as<bool>(v, false); }},
+				{"killEncoding", [](WorkspaceDetails &w, json &v) { w.killEncoding = JsonSaxReader::as<bool>(v, false); }},
+				{"cancelIngestionJob", [](WorkspaceDetails &w, json &v) { w.cancelIngestionJob = JsonSaxReader::as<bool>(v, false); }},
+				{"editEncodersPool", [](WorkspaceDetails &w, json &v) { w.editEncodersPool = JsonSaxReader::as<bool>(v, false); }},
+				{"applicationRecorder", [](WorkspaceDetails &w, json &v) { w.applicationRecorder = JsonSaxReader::as<bool>(v, false); }},
+				{"appUploadMediaContent", [](WorkspaceDetails &w, json &v) { w.appUploadMediaContent = JsonSaxReader::as<bool>(v, false); }},
+				{"appCaptureScreenAndProxy", [](WorkspaceDetails &w, json &v) { w.appCaptureScreenAndProxy = JsonSaxReader::as<bool>(v, false); }},
+				{"appStreamAndProxy", [](WorkspaceDetails &w, json &v) { w.appStreamAndProxy = JsonSaxReader::as<bool>(v, false); }},
+			};
+
+			return setters;
+		}
+	};
+
+	class CostTarget : public StructTarget<WorkspaceDetails>
+	{
+	  public:
+		CostTarget() : StructTarget(setters()) {}
+
+		void bind(WorkspaceDetails *workspaceDetails) { _object = workspaceDetails; }
+
+	  private:
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"maxStorageInGB", [](WorkspaceDetails &w, json &v) { w.maxStorageInGB = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"currentCostForStorage", [](WorkspaceDetails &w, json &v) { w.currentCostForStorage = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"dedicatedEncoder_power_1", [](WorkspaceDetails &w, json &v) { w.dedicatedEncoder_power_1 = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"currentCostForDedicatedEncoder_power_1",
+				 [](WorkspaceDetails &w, json &v) { w.currentCostForDedicatedEncoder_power_1 = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"dedicatedEncoder_power_2", [](WorkspaceDetails &w, json &v) { w.dedicatedEncoder_power_2 = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"currentCostForDedicatedEncoder_power_2",
+				 [](WorkspaceDetails &w, json &v) { w.currentCostForDedicatedEncoder_power_2 = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"dedicatedEncoder_power_3", [](WorkspaceDetails &w, json &v) { w.dedicatedEncoder_power_3 = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"currentCostForDedicatedEncoder_power_3",
+				 [](WorkspaceDetails &w, json &v) { w.currentCostForDedicatedEncoder_power_3 = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"CDN_type_1", [](WorkspaceDetails &w, json &v) { w.CDN_type_1 = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"currentCostForCDN_type_1", [](WorkspaceDetails &w, json &v) { w.currentCostForCDN_type_1 = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"support_type_1", [](WorkspaceDetails &w, json &v) { w.support_type_1 = JsonSaxReader::as<bool>(v, false); }},
+				{"currentCostForSupport_type_1", [](WorkspaceDetails &w, json &v) { w.currentCostForSupport_type_1 = JsonSaxReader::as<int64_t>(v, -1); }},
+			};
+
+			return setters;
+		}
+	};
+
+	class WorkspaceDetailsTarget : public StructTarget<WorkspaceDetails>
+	{
+	  public:
+		WorkspaceDetailsTarget() : StructTarget(setters()) {}
+
+		void bind(WorkspaceDetails *workspaceDetails)
+		{
+			_object = workspaceDetails;
+			*_object = WorkspaceDetails();
+			_object->workspaceKey = -1;
+			_object->maxIngestionsNumber = -1;
+			_object->usageInMB = -1;
+			_object->preferences = nullptr;
+			_object->workspaceOwnerUserKey = -1;
+			_object->maxStorageInGB = -1;
+			_object->currentCostForStorage = -1;
+			_object->dedicatedEncoder_power_1 = -1;
+			_object->currentCostForDedicatedEncoder_power_1 = -1;
+			_object->dedicatedEncoder_power_2 = -1;
+			_object->currentCostForDedicatedEncoder_power_2 = -1;
+			_object->dedicatedEncoder_power_3 = -1;
+			_object->currentCostForDedicatedEncoder_power_3 = -1;
+			_object->CDN_type_1 = -1;
+			_object->currentCostForCDN_type_1 = -1;
+			_object->currentCostForSupport_type_1 = -1;
+
+			_userAPIKeyTarget.bind(workspaceDetails);
+			_costTarget.bind(workspaceDetails);
+		}
+
+		Target *nested(const string &key) override
+		{
+			if (key == "userAPIKey")
+				return &_userAPIKeyTarget;
+			else if (key == "cost")
+				return &_costTarget;
+
+			return nullptr;
+		}
+
+	  private:
+		UserAPIKeyTarget _userAPIKeyTarget;
+		CostTarget _costTarget;
+
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"workspaceKey", [](WorkspaceDetails &w, json &v) { w.workspaceKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"enabled", [](WorkspaceDetails &w, json &v) { w.enabled = JsonSaxReader::as<bool>(v, false); }},
+				{"workspaceName", [](WorkspaceDetails &w, json &v) { w.name = JsonSaxReader::as<string>(v, ""); }},
+				{"maxEncodingPriority", [](WorkspaceDetails &w, json &v) { w.maxEncodingPriority = JsonSaxReader::as<string>(v, ""); }},
+				{"encodingPeriod", [](WorkspaceDetails &w, json &v) { w.encodingPeriod = JsonSaxReader::as<string>(v, ""); }},
+				{"maxIngestionsNumber", [](WorkspaceDetails &w, json &v) { w.maxIngestionsNumber = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"workSpaceUsageInMB", [](WorkspaceDetails &w, json &v) { w.usageInMB = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"languageCode", [](WorkspaceDetails &w, json &v) { w.languageCode = JsonSaxReader::as<string>(v, ""); }},
+				{"timezone", [](WorkspaceDetails &w, json &v) { w.timezone = JsonSaxReader::as<string>(v, ""); }},
+				{"preferences",
+				 [](WorkspaceDetails &w, json &v)
+				 {
+					 string preferences = JsonSaxReader::as<string>(v, "");
+					 if (preferences.empty())
+						 return;
+					 try
+					 {
+						 w.preferences = JSONUtils::toJson<json>(preferences);
+					 }
+					 catch (exception &e)
+					 {
+						 SPDLOG_ERROR("Wrong workspaceDetails.preferences format: {}", preferences);
+					 }
+				 }},
+				{"creationDate", [](WorkspaceDetails &w, json &v) { w.creationDate = asUtcInSecs(v); }},
+				{"workspaceOwnerUserKey", [](WorkspaceDetails &w, json &v) { w.workspaceOwnerUserKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"workspaceOwnerUserName", [](WorkspaceDetails &w, json &v) { w.workspaceOwnerUserName = JsonSaxReader::as<string>(v, ""); }},
+			};
+
+			return setters;
+		}
+	};
+
+	// login response: user profile, its workspace and mmsVersion
+	class LoginTarget : public StructTarget<UserProfile>
+	{
+	  public:
+		LoginTarget(UserProfile *userProfile, WorkspaceDetails *workspaceDetails, string *mmsVersion)
+			: StructTarget(setters()), _workspaceDetails(workspaceDetails), _mmsVersion(mmsVersion), workspacePresent(false)
+		{
+			_object = userProfile;
+			*_object = UserProfile();
+			_object->userKey = -1;
+		}
+
+		void value(const string &key, json &value) override
+		{
+			if (key == "mmsVersion")
+				*_mmsVersion = JsonSaxReader::as<string>(value, "");
+			else
+				StructTarget::value(key, value);
+		}
+
+		Target *nested(const string &key) override
+		{
+			if (key != "workspace")
+				return nullptr;
+
+			workspacePresent = true;
+			_workspaceDetailsTarget.bind(_workspaceDetails);
+
+			return &_workspaceDetailsTarget;
+		}
+
+	  private:
+		WorkspaceDetails *_workspaceDetails;
+		string *_mmsVersion;
+		WorkspaceDetailsTarget _workspaceDetailsTarget;
+
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"userKey", [](UserProfile &u, json &v) { u.userKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"ldapEnabled", [](UserProfile &u, json &v) { u.ldapEnabled = JsonSaxReader::as<bool>(v, false); }},
+				{"name", [](UserProfile &u, json &v) { u.name = JsonSaxReader::as<string>(v, ""); }},
+				{"country", [](UserProfile &u, json &v) { u.country = JsonSaxReader::as<string>(v, ""); }},
+				{"timezone", [](UserProfile &u, json &v) { u.timezone = JsonSaxReader::as<string>(v, ""); }},
+				{"email", [](UserProfile &u, json &v) { u.email = JsonSaxReader::as<string>(v, ""); }},
+				{"creationDate", [](UserProfile &u, json &v) { u.creationDate = asUtcInSecs(v); }},
+				{"insolvent", [](UserProfile &u, json &v) { u.insolvent = JsonSaxReader::as<bool>(v, false); }},
+				{"expirationDate", [](UserProfile &u, json &v) { u.expirationDate = asUtcInSecs(v); }},
+			};
+
+			return setters;
+		}
+
+	  public:
+		bool workspacePresent;
+	};
+
+	// ingestionRootKey of the workflow or ingestionJobKey of a task
+	class IngestionResultTarget : public JsonSaxReader::Target
+	{
+	  public:
+		explicit IngestionResultTarget(string keyName) : _keyName(std::move(keyName)), _ingestionResult(nullptr) {}
+
+		void bind(IngestionResult *ingestionResult)
+		{
+			_ingestionResult = ingestionResult;
+			_ingestionResult->key = -1;
+			_ingestionResult->label = "";
+		}
+
+		void value(const string &key, json &value) override
+		{
+			if (key == _keyName)
+				_ingestionResult->key = JsonSaxReader::as<int64_t>(value, -1);
+			else if (key == "label")
+				_ingestionResult->label = JsonSaxReader::as<string>(value, "");
+		}
+
+	  private:
+		string _keyName;
+		IngestionResult *_ingestionResult;
+	};
+
+	class IngestionWorkflowTarget : public JsonSaxReader::Target
+	{
+	  public:
+		IngestionWorkflowTarget(IngestionResult *workflowResult, vector<IngestionResult> *ingestionJobs)
+			: _workflowTarget("ingestionRootKey"), _tasksTarget(ingestionJobs, "ingestionJobKey")
+		{
+			_workflowTarget.bind(workflowResult);
+		}
+
+		Target *nested(const string &key) override
+		{
+			if (key == "workflow")
+				return &_workflowTarget;
+			else if (key == "tasks")
+				return &_tasksTarget;
+
+			return nullptr;
+		}
+
+	  private:
+		IngestionResultTarget _workflowTarget;
+		JsonSaxReader::ArrayTarget<IngestionResult, IngestionResultTarget> _tasksTarget;
+	};
+
+	class EncodingProfileTarget : public StructTarget<EncodingProfile>
+	{
+	  public:
+		EncodingProfileTarget() : StructTarget(setters()) {}
+
+		void bind(EncodingProfile *encodingProfile)
+		{
+			_object = encodingProfile;
+			_object->encodingProfileKey = -1;
+			_object->global = false;
+		}
+
+		json *captured(const string &key) override { return key == "profile" ? &_object->encodingProfileRoot : nullptr; }
+
+		void end() override
+		{
+			if (_object->encodingProfileRoot.is_object())
+			{
+				if (auto it = _object->encodingProfileRoot.find("fileFormat"); it != _object->encodingProfileRoot.end())
+				{
+					json fileFormat = *it;
+					_object->fileFormat = JsonSaxReader::as<string>(fileFormat, "");
+				}
+				if (auto it = _object->encodingProfileRoot.find("description"); it != _object->encodingProfileRoot.end())
 				{
-					json bitRatesRoot = JsonPath(&audioInfoRoot)["bitRates"].as<json>(json::array());
-					for (auto &[keyRoot, valRoot] : bitRatesRoot.items())
-						encodingProfile.audioDetails.kBitRates.push_back(JsonPath(&valRoot)["kBitRate"].as<int32_t>(-1));
+					json description = *it;
+					_object->description = JsonSaxReader::as<string>(description, "");
 				}
 			}
-			else if (encodingProfile.contentType == "image")
+		}
+
+	  private:
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"global", [](EncodingProfile &p, json &v) { p.global = JsonSaxReader::as<bool>(v, false); }},
+				{"encodingProfileKey", [](EncodingProfile &p, json &v) { p.encodingProfileKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"label", [](EncodingProfile &p, json &v) { p.label = JsonSaxReader::as<string>(v, ""); }},
+				{"contentType", [](EncodingProfile &p, json &v) { p.contentType = JsonSaxReader::as<string>(v, ""); }},
+			};
+
+			return setters;
+		}
+	};
+
+	class EncodingProfilesSetTarget : public StructTarget<EncodingProfilesSet>
+	{
+	  public:
+		EncodingProfilesSetTarget() : StructTarget(setters()), _encodingProfilesTarget(nullptr) {}
+
+		void bind(EncodingProfilesSet *encodingProfilesSet)
+		{
+			_object = encodingProfilesSet;
+			_object->encodingProfilesSetKey = -1;
+			_encodingProfilesTarget.bind(&encodingProfilesSet->encodingProfiles);
+		}
+
+		Target *nested(const string &key) override { return key == "encodingProfiles" ? &_encodingProfilesTarget : nullptr; }
+
+	  private:
+		JsonSaxReader::ArrayTarget<EncodingProfile, EncodingProfileTarget> _encodingProfilesTarget;
+
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"encodingProfilesSetKey", [](EncodingProfilesSet &s, json &v) { s.encodingProfilesSetKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"contentType", [](EncodingProfilesSet &s, json &v) { s.contentType = JsonSaxReader::as<string>(v, ""); }},
+				{"label", [](EncodingProfilesSet &s, json &v) { s.label = JsonSaxReader::as<string>(v, ""); }},
+			};
+
+			return setters;
+		}
+	};
+
+	class EncoderTarget : public StructTarget<Encoder>
+	{
+	  public:
+		EncoderTarget() : StructTarget(setters()) {}
+
+		void bind(Encoder *encoder)
+		{
+			_object = encoder;
+			_object->encoderKey = -1;
+			_object->external = false;
+			_object->enabled = false;
+			_object->port = -1;
+			_object->running = false;
+			_object->cpuUsage = -1;
+			_object->workspacesAssociatedRoot = json::array();
+		}
+
+		json *captured(const string &key) override { return key == "workspacesAssociated" ? &_object->workspacesAssociatedRoot : nullptr; }
+
+	  private:
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"encoderKey", [](Encoder &e, json &v) { e.encoderKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"label", [](Encoder &e, json &v) { e.label = JsonSaxReader::as<string>(v, ""); }},
+				{"external", [](Encoder &e, json &v) { e.external = JsonSaxReader::as<bool>(v, false); }},
+				{"enabled", [](Encoder &e, json &v) { e.enabled = JsonSaxReader::as<bool>(v, false); }},
+				{"protocol", [](Encoder &e, json &v) { e.protocol = JsonSaxReader::as<string>(v, ""); }},
+				{"publicServerName", [](Encoder &e, json &v) { e.publicServerName = JsonSaxReader::as<string>(v, ""); }},
+				{"internalServerName", [](Encoder &e, json &v) { e.internalServerName = JsonSaxReader::as<string>(v, ""); }},
+				{"port", [](Encoder &e, json &v) { e.port = JsonSaxReader::as<int32_t>(v, -1); }},
+				{"running", [](Encoder &e, json &v) { e.running = JsonSaxReader::as<bool>(v, false); }},
+				{"cpuUsage", [](Encoder &e, json &v) { e.cpuUsage = JsonSaxReader::as<int32_t>(v, -1); }},
+			};
+
+			return setters;
+		}
+	};
+
+	class EncodersPoolTarget : public StructTarget<EncodersPool>
+	{
+	  public:
+		EncodersPoolTarget() : StructTarget(setters()), _encodersTarget(nullptr) {}
+
+		void bind(EncodersPool *encodersPool)
+		{
+			_object = encodersPool;
+			_object->encodersPoolKey = -1;
+			_encodersTarget.bind(&encodersPool->encoders);
+		}
+
+		Target *nested(const string &key) override { return key == "encoders" ? &_encodersTarget : nullptr; }
+
+	  private:
+		JsonSaxReader::ArrayTarget<Encoder, EncoderTarget> _encodersTarget;
+
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"encodersPoolKey", [](EncodersPool &p, json &v) { p.encodersPoolKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"label", [](EncodersPool &p, json &v) { p.label = JsonSaxReader::as<string>(v, ""); }},
+			};
+
+			return setters;
+		}
+	};
+
+	class RTMPChannelConfTarget : public StructTarget<RTMPChannelConf>
+	{
+	  public:
+		RTMPChannelConfTarget() : StructTarget(setters()) {}
+
+		void bind(RTMPChannelConf *rtmpChannelConf)
+		{
+			_object = rtmpChannelConf;
+			_object->confKey = -1;
+			_object->playURLDetails = nullptr;
+			_object->outputIndex = -1;
+			_object->reservedByIngestionJobKey = -1;
+		}
+
+		json *captured(const string &key) override { return key == "playURLDetails" ? &_object->playURLDetails : nullptr; }
+
+	  private:
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"confKey", [](RTMPChannelConf &c, json &v) { c.confKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"label", [](RTMPChannelConf &c, json &v) { c.label = JsonSaxReader::as<string>(v, ""); }},
+				{"rtmpURL", [](RTMPChannelConf &c, json &v) { c.rtmpURL = JsonSaxReader::as<string>(v, ""); }},
+				{"streamName", [](RTMPChannelConf &c, json &v) { c.streamName = JsonSaxReader::as<string>(v, ""); }},
+				{"userName", [](RTMPChannelConf &c, json &v) { c.userName = JsonSaxReader::as<string>(v, ""); }},
+				{"password", [](RTMPChannelConf &c, json &v) { c.password = JsonSaxReader::as<string>(v, ""); }},
+				{"type", [](RTMPChannelConf &c, json &v) { c.type = JsonSaxReader::as<string>(v, ""); }},
+				{"outputIndex", [](RTMPChannelConf &c, json &v) { c.outputIndex = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"reservedByIngestionJobKey", [](RTMPChannelConf &c, json &v) { c.reservedByIngestionJobKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"configurationLabel", [](RTMPChannelConf &c, json &v) { c.configurationLabel = JsonSaxReader::as<string>(v, ""); }},
+			};
+
+			return setters;
+		}
+	};
+
+	class SRTChannelConfTarget : public StructTarget<SRTChannelConf>
+	{
+	  public:
+		SRTChannelConfTarget() : StructTarget(setters()) {}
+
+		void bind(SRTChannelConf *srtChannelConf)
+		{
+			_object = srtChannelConf;
+			_object->confKey = -1;
+			_object->mode = "caller";
+			_object->outputIndex = -1;
+			_object->reservedByIngestionJobKey = -1;
+		}
+
+	  private:
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"confKey", [](SRTChannelConf &c, json &v) { c.confKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"label", [](SRTChannelConf &c, json &v) { c.label = JsonSaxReader::as<string>(v, ""); }},
+				{"srtURL", [](SRTChannelConf &c, json &v) { c.srtURL = JsonSaxReader::as<string>(v, ""); }},
+				{"mode", [](SRTChannelConf &c, json &v) { c.mode = JsonSaxReader::as<string>(v, "caller"); }},
+				{"streamId", [](SRTChannelConf &c, json &v) { c.streamId = JsonSaxReader::as<string>(v, ""); }},
+				{"passphrase", [](SRTChannelConf &c, json &v) { c.passphrase = JsonSaxReader::as<string>(v, ""); }},
+				{"playURL", [](SRTChannelConf &c, json &v) { c.playURL = JsonSaxReader::as<string>(v, ""); }},
+				{"type", [](SRTChannelConf &c, json &v) { c.type = JsonSaxReader::as<string>(v, ""); }},
+				{"outputIndex", [](SRTChannelConf &c, json &v) { c.outputIndex = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"reservedByIngestionJobKey", [](SRTChannelConf &c, json &v) { c.reservedByIngestionJobKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"configurationLabel", [](SRTChannelConf &c, json &v) { c.configurationLabel = JsonSaxReader::as<string>(v, ""); }},
+			};
+
+			return setters;
+		}
+	};
+
+	class StreamTarget : public StructTarget<Stream>
+	{
+	  public:
+		StreamTarget() : StructTarget(setters()) {}
+
+		void bind(Stream *stream)
+		{
+			_object = stream;
+			_object->confKey = -1;
+			_object->encodersPoolKey = -1;
+			_object->pushEncoderKey = -1;
+			_object->pushPublicEncoderName = false;
+			_object->pushServerPort = -1;
+			_object->pushListenTimeout = -1;
+			_object->captureLiveVideoDeviceNumber = -1;
+			_object->captureLiveFrameRate = -1;
+			_object->captureLiveWidth = -1;
+			_object->captureLiveHeight = -1;
+			_object->captureLiveAudioDeviceNumber = -1;
+			_object->captureLiveChannelsNumber = -1;
+			_object->tvSourceTVConfKey = -1;
+			_object->imageMediaItemKey = -1;
+			_object->position = -1;
+		}
+
+	  private:
+		static const Setters &setters()
+		{
+			static const Setters setters = {
+				{"confKey", [](Stream &s, json &v) { s.confKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"label", [](Stream &s, json &v) { s.label = JsonSaxReader::as<string>(v, ""); }},
+				{"sourceType", [](Stream &s, json &v) { s.sourceType = JsonSaxReader::as<string>(v, ""); }},
+				{"encodersPoolKey", [](Stream &s, json &v) { s.encodersPoolKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"encodersPoolLabel", [](Stream &s, json &v) { s.encodersPoolLabel = JsonSaxReader::as<string>(v, ""); }},
+				{"url", [](Stream &s, json &v) { s.url = JsonSaxReader::as<string>(v, ""); }},
+				{"pushProtocol", [](Stream &s, json &v) { s.pushProtocol = JsonSaxReader::as<string>(v, ""); }},
+				{"pushEncoderKey", [](Stream &s, json &v) { s.pushEncoderKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"pushPublicEncoderName", [](Stream &s, json &v) { s.pushPublicEncoderName = JsonSaxReader::as<bool>(v, false); }},
+				{"pushEncoderLabel", [](Stream &s, json &v) { s.pushEncoderLabel = JsonSaxReader::as<string>(v, ""); }},
+				{"pushEncoderName", [](Stream &s, json &v) { s.pushEncoderName = JsonSaxReader::as<string>(v, ""); }},
+				{"pushServerPort", [](Stream &s, json &v) { s.pushServerPort = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"pushUri", [](Stream &s, json &v) { s.pushURI = JsonSaxReader::as<string>(v, ""); }},
+				{"pushListenTimeout", [](Stream &s, json &v) { s.pushListenTimeout = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"captureLiveVideoDeviceNumber", [](Stream &s, json &v) { s.captureLiveVideoDeviceNumber = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"captureLiveVideoInputFormat", [](Stream &s, json &v) { s.captureLiveVideoInputFormat = JsonSaxReader::as<string>(v, ""); }},
+				{"captureLiveFrameRate", [](Stream &s, json &v) { s.captureLiveFrameRate = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"captureLiveWidth", [](Stream &s, json &v) { s.captureLiveWidth = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"captureLiveHeight", [](Stream &s, json &v) { s.captureLiveHeight = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"captureLiveAudioDeviceNumber", [](Stream &s, json &v) { s.captureLiveAudioDeviceNumber = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"captureLiveChannelsNumber", [](Stream &s, json &v) { s.captureLiveChannelsNumber = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"tvSourceTVConfKey", [](Stream &s, json &v) { s.tvSourceTVConfKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"type", [](Stream &s, json &v) { s.type = JsonSaxReader::as<string>(v, ""); }},
+				{"description", [](Stream &s, json &v) { s.description = JsonSaxReader::as<string>(v, ""); }},
+				{"name", [](Stream &s, json &v) { s.name = JsonSaxReader::as<string>(v, ""); }},
+				{"region", [](Stream &s, json &v) { s.region = JsonSaxReader::as<string>(v, ""); }},
+				{"country", [](Stream &s, json &v) { s.country = JsonSaxReader::as<string>(v, ""); }},
+				{"imageMediaItemKey", [](Stream &s, json &v) { s.imageMediaItemKey = JsonSaxReader::as<int64_t>(v, -1); }},
+				{"imageUniqueName", [](Stream &s, json &v) { s.imageUniqueName = JsonSaxReader::as<string>(v, ""); }},
+				{"position", [](Stream &s, json &v) { s.position = JsonSaxReader::as<int16_t>(v, -1); }},
+				{"userData", [](Stream &s, json &v) { s.userData = JsonSaxReader::as<string>(v, ""); }},
+			};
+
+			return setters;
+		}
+	};
+
+	// {"response": {"<arrayName>": [...], "numFound": ...}}, the array elements filled by ElementTarget
+	template <typename T, typename ElementTarget> class ResponseTarget : public JsonSaxReader::Target
+	{
+	  public:
+		template <typename... Args>
+		ResponseTarget(string arrayName, vector<T> *elements, int64_t *numFound, Args &&...args)
+			: _arrayName(std::move(arrayName)), _numFound(numFound), _arrayTarget(elements, args...), _contentTarget(this)
+		{
+		}
+
+		Target *nested(const string &key) override { return key == "response" ? &_contentTarget : nullptr; }
+
+	  private:
+		class ContentTarget : public JsonSaxReader::Target
+		{
+		  public:
+			explicit ContentTarget(ResponseTarget *responseTarget) : _responseTarget(responseTarget) {}
+
+			void value(const string &key, json &value) override
 			{
-				json imageInfoRoot = JsonPath(&encodingProfile.encodingProfileRoot)["image"].as<json>();
-				encodingProfile.imageDetails.width = JsonPath(&imageInfoRoot)["width"].as<int32_t>(-1);
-				encodingProfile.imageDetails.height = JsonPath(&imageInfoRoot)["height"].as<int32_t>(-1);
-				encodingProfile.imageDetails.aspectRatio = JsonPath(&imageInfoRoot)["aspectRatio"].as<bool>(false);
-				encodingProfile.imageDetails.maxWidth = JsonPath(&imageInfoRoot)["maxWidth"].as<int32_t>(-1);
-				encodingProfile.imageDetails.maxHeight = JsonPath(&imageInfoRoot)["maxHeight"].as<int32_t>(-1);
-				encodingProfile.imageDetails.interlaceType = JsonPath(&imageInfoRoot)["interlaceType"].as<string>();
+				if (key == "numFound" && _responseTarget->_numFound != nullptr)
+					*_responseTarget->_numFound = JsonSaxReader::as<int64_t>(value, 0);
 			}
-		}
+			Target *nested(const string &key) override { return key == _responseTarget->_arrayName ? &_responseTarget->_arrayTarget : nullptr; }
+
+		  private:
+			ResponseTarget *_responseTarget;
+		};
+
+		string _arrayName;
+		int64_t *_numFound;
+		JsonSaxReader::ArrayTarget<T, ElementTarget> _arrayTarget;
+		ContentTarget _contentTarget;
+	};
+};
+
+bool CatraMMSAPI::parseLogin(const string &responseBody, UserProfile &userProfile, WorkspaceDetails &workspaceDetails, string &mmsVersion)
+{
+	SaxTargets::LoginTarget loginTarget(&userProfile, &workspaceDetails, &mmsVersion);
+	JsonSaxReader::parse(responseBody, &loginTarget);
+
+	return loginTarget.workspacePresent;
+}
+
+pair<CatraMMSAPI::IngestionResult, vector<CatraMMSAPI::IngestionResult>> CatraMMSAPI::parseIngestionWorkflow(const string &responseBody)
+{
+	IngestionResult workflowResult;
+	vector<IngestionResult> ingestionJobs;
+
+	SaxTargets::IngestionWorkflowTarget ingestionWorkflowTarget(&workflowResult, &ingestionJobs);
+	JsonSaxReader::parse(responseBody, &ingestionWorkflowTarget);
+
+	return make_pair(workflowResult, ingestionJobs);
+}
+
+vector<CatraMMSAPI::EncodingProfile> CatraMMSAPI::parseEncodingProfiles(const JsonSaxReader::Input &responseBody)
+{
+	vector<EncodingProfile> encodingProfiles;
+
+	SaxTargets::ResponseTarget<EncodingProfile, SaxTargets::EncodingProfileTarget> responseTarget("encodingProfiles", &encodingProfiles, nullptr);
+	JsonSaxReader::parse(responseBody, &responseTarget);
+
+	return encodingProfiles;
+}
+
+vector<CatraMMSAPI::EncodingProfilesSet> CatraMMSAPI::parseEncodingProfilesSets(const JsonSaxReader::Input &responseBody)
+{
+	vector<EncodingProfilesSet> encodingProfilesSets;
+
+	SaxTargets::ResponseTarget<EncodingProfilesSet, SaxTargets::EncodingProfilesSetTarget> responseTarget(
+		"encodingProfilesSets", &encodingProfilesSets, nullptr
+	);
+	JsonSaxReader::parse(responseBody, &responseTarget);
+
+	return encodingProfilesSets;
+}
+
+vector<CatraMMSAPI::EncodersPool> CatraMMSAPI::parseEncodersPool(const JsonSaxReader::Input &responseBody)
+{
+	vector<EncodersPool> encodersPool;
+
+	SaxTargets::ResponseTarget<EncodersPool, SaxTargets::EncodersPoolTarget> responseTarget("encodersPool", &encodersPool, nullptr);
+	JsonSaxReader::parse(responseBody, &responseTarget);
+
+	return encodersPool;
+}
+
+vector<CatraMMSAPI::RTMPChannelConf> CatraMMSAPI::parseRTMPChannelConfs(const JsonSaxReader::Input &responseBody)
+{
+	vector<RTMPChannelConf> rtmpChannelConfs;
+
+	SaxTargets::ResponseTarget<RTMPChannelConf, SaxTargets::RTMPChannelConfTarget> responseTarget("rtmpChannelConf", &rtmpChannelConfs, nullptr);
+	JsonSaxReader::parse(responseBody, &responseTarget);
+
+	return rtmpChannelConfs;
+}
+
+vector<CatraMMSAPI::SRTChannelConf> CatraMMSAPI::parseSRTChannelConfs(const JsonSaxReader::Input &responseBody)
+{
+	vector<SRTChannelConf> srtChannelConfs;
+
+	SaxTargets::ResponseTarget<SRTChannelConf, SaxTargets::SRTChannelConfTarget> responseTarget("srtChannelConf", &srtChannelConfs, nullptr);
+	JsonSaxReader::parse(responseBody, &responseTarget);
+
+	return srtChannelConfs;
+}
+
+pair<vector<CatraMMSAPI::Stream>, int64_t> CatraMMSAPI::parseStreams(const JsonSaxReader::Input &responseBody)
+{
+	vector<Stream> streams;
+	int64_t numFound = 0;
+
+	SaxTargets::ResponseTarget<Stream, SaxTargets::StreamTarget> responseTarget("streams", &streams, &numFound);
+	JsonSaxReader::parse(responseBody, &responseTarget);
+
+	return make_pair(std::move(streams), numFound);
+}
+
+string CatraMMSAPI::catalogCacheKey(const Session &session, const string &url) const
+{
+	// should_bypass_cache is always the last parameter of the url and it is not part of the key
+	return std::format("{}:{}", session.workspaceDetails.workspaceKey, url.substr(0, url.rfind("should_bypass_cache=")));
+}
+
+shared_ptr<const any> CatraMMSAPI::catalogCacheLookup(const string &cacheKey, bool cacheAllowed, optional<CatalogCache::Entry> &entry)
+{
+	if (!cacheAllowed)
+		return nullptr;
 
-		return encodingProfile;
+	entry = _catalogCache->get(cacheKey);
+	if (entry && chrono::steady_clock::now() < entry->expiration)
+		return entry->value;
+
+	return nullptr;
+}
+
+shared_ptr<const any> CatraMMSAPI::catalogCacheStore(
+	const string &cacheKey, int32_t ttlInSeconds, const optional<CatalogCache::Entry> &entry, const CurlConnectionPool::HttpResponse &response,
+	const function<any(const string &)> &fill
+)
+{
+	chrono::steady_clock::time_point expiration = chrono::steady_clock::now() + chrono::seconds(ttlInSeconds);
+
+	if (response.httpCode == 304 && entry)
+	{
+		LOG_DEBUG(
+			"Cache entry revalidated"
+			", cacheKey: {}"
+			", eTag: {}",
+			cacheKey, entry->eTag
+		);
+		_catalogCache->refresh(cacheKey, expiration);
+
+		return entry->value;
+	}
+
+	auto value = make_shared<const any>(fill(response.body));
+	_catalogCache->put(cacheKey, {value, response.eTag, expiration});
+
+	return value;
+}
+
+shared_ptr<const any> CatraMMSAPI::catalogSnapshotLookup(
+	const Session &session, const string &api, const string &url, const string &cacheKey, int32_t ttlInSeconds,
+	const function<any(istream &)> &fill
+)
+{
+	if (!_catalogSnapshot)
+		return nullptr;
+
+	optional<CatalogSnapshot::Entry> snapshotEntry = _catalogSnapshot->get(cacheKey);
+	if (!snapshotEntry)
+		return nullptr;
+
+	shared_ptr<const any> value;
+	try
+	{
+		// parsed straight from the mapped file
+		CatalogSnapshot::BodyBuffer bodyBuffer(snapshotEntry->body);
+		istream responseBody(&bodyBuffer);
+		value = make_shared<const any>(_metrics->parse(api, [&]() { return fill(responseBody); }));
 	}
 	catch (exception &e)
 	{
-		SPDLOG_ERROR(
-			"fillEncodingProfile failed"
+		LOG_WARN(
+			"Catalog snapshot entry not valid, ignored"
+			", cacheKey: {}"
 			", exception: {}",
-			e.what()
+			cacheKey, e.what()
 		);
-		throw;
+
+		return nullptr;
 	}
+
+	LOG_INFO(
+		"Catalog from snapshot, revalidated in background"
+		", cacheKey: {}"
+		", eTag: {}",
+		cacheKey, snapshotEntry->eTag
+	);
+
+	CatalogCache::Entry entry{value, string(snapshotEntry->eTag), chrono::steady_clock::now() + chrono::seconds(ttlInSeconds)};
+	_catalogCache->put(cacheKey, entry);
+
+	CurlConnectionPool::HttpRequest request{
+		url, _apiTimeoutInSeconds, session.authorization, apiOtherHeaders(), nullopt, "", _outputToBeCompressed, true, api
+	};
+	if (!entry.eTag.empty())
+		request.otherHeaders.push_back(std::format("If-None-Match: {}", entry.eTag));
+
+	eventLoop()->submit(
+		std::move(request), _apiMaxRetries,
+		[this, api, cacheKey, ttlInSeconds, entry, fill](CurlConnectionPool::HttpResponse &&response, exception_ptr error)
+		{
+			// not parsed by the event loop thread, it would stop the other transfers
+			workerPool()->post(
+				[this, api, cacheKey, ttlInSeconds, entry, fill, response = std::move(response), error]() mutable
+				{
+					try
+					{
+						if (error)
+							rethrow_exception(error);
+
+						catalogCacheStore(
+							cacheKey, ttlInSeconds, entry, response,
+							[this, &api, &fill](const string &responseBody) -> any
+							{
+								CatalogSnapshot::BodyBuffer bodyBuffer(responseBody);
+								istream bodyStream(&bodyBuffer);
+
+								return _metrics->parse(api, [&]() { return fill(bodyStream); });
+							}
+						);
+						if (response.httpCode != 304)
+							catalogSnapshotStore(cacheKey, response.eTag, std::move(response.body));
+					}
+					catch (exception &e)
+					{
+						// the snapshot value is used until its expiration, then it is revalidated again
+						LOG_WARN(
+							"Catalog snapshot revalidation failed"
+							", cacheKey: {}"
+							", exception: {}",
+							cacheKey, e.what()
+						);
+					}
+				}
+			);
+		}
+	);
+
+	return value;
 }
 
-CatraMMSAPI::EncodingProfilesSet CatraMMSAPI::fillEncodingProfilesSet(const json& encodingProfilesSetRoot, const bool deep)
+void CatraMMSAPI::catalogSnapshotStore(const string &cacheKey, const string &eTag, string body)
 {
+	if (!_catalogSnapshot)
+		return;
+
 	try
 	{
-		EncodingProfilesSet encodingProfilesSet;
+		_catalogSnapshot->put(cacheKey, eTag, std::move(body));
+	}
+	catch (exception &)
+	{
+		// already logged, the snapshot is saved again by the next put
+	}
+}
+
+any CatraMMSAPI::cachedGetJson(
+	const Session &session, const string &api, const string &url, int32_t ttlInSeconds, bool cacheAllowed, const function<any(istream &)> &fill
+)
+{
+	bool toBeCached = _cacheEnabled && ttlInSeconds > 0;
+	string cacheKey = catalogCacheKey(session, url);
 
-		encodingProfilesSet.encodingProfilesSetKey = JsonPath(&encodingProfilesSetRoot)["encodingProfilesSetKey"].as<int64_t>(-1);
-		encodingProfilesSet.contentType = JsonPath(&encodingProfilesSetRoot)["contentType"].as<string>();
-		encodingProfilesSet.label = JsonPath(&encodingProfilesSetRoot)["label"].as<string>();
-		if (deep)
+	optional<CatalogCache::Entry> entry;
+	if (toBeCached)
+	{
+		if (shared_ptr<const any> cachedValue = catalogCacheLookup(cacheKey, cacheAllowed, entry))
+			return *cachedValue;
+		if (cacheAllowed && !entry)
 		{
-			json encodingProfilesRoot = JsonPath(&encodingProfilesSetRoot)["encodingProfiles"].as<json>(json::array());
-			for (auto &[keyRoot, valRoot] : encodingProfilesRoot.items())
-				encodingProfilesSet.encodingProfiles.push_back(fillEncodingProfile(valRoot, deep));
+			if (shared_ptr<const any> snapshotValue = catalogSnapshotLookup(session, api, url, cacheKey, ttlInSeconds, fill))
+				return *snapshotValue;
 		}
-
-		return encodingProfilesSet;
 	}
-	catch (exception &e)
+
+	// the identical calls arriving meanwhile wait for this one
+	bool coalesced = false;
+	shared_ptr<const any> value;
+	try
 	{
-		SPDLOG_ERROR(
-			"fillEncodingProfilesSet failed"
-			", exception: {}",
-			e.what()
+		value = _inFlightGets->run(
+			cacheKey,
+			[&]() -> shared_ptr<const any>
+			{
+				any parsedValue;
+				if (!toBeCached)
+				{
+					streamedGet(session, api, url, "", fill, parsedValue);
+
+					return make_shared<const any>(std::move(parsedValue));
+				}
+
+				// the body is kept to be saved in the snapshot
+				string responseBody;
+				function<any(istream &)> keepingBody = [&fill, &responseBody](istream &bodyStream) -> any
+				{
+					CatalogSnapshot::TeeBuffer teeBuffer(bodyStream.rdbuf(), responseBody);
+					istream keptBodyStream(&teeBuffer);
+					any value = fill(keptBodyStream);
+					// the bytes after the parsed JSON (if any) are kept too
+					keptBodyStream.ignore(numeric_limits<streamsize>::max());
+
+					return value;
+				};
+				CurlConnectionPool::HttpResponse response =
+					streamedGet(session, api, url, entry ? entry->eTag : "", _catalogSnapshot ? keepingBody : fill, parsedValue);
+				if (response.httpCode != 304)
+					catalogSnapshotStore(cacheKey, response.eTag, std::move(responseBody));
+
+				return catalogCacheStore(cacheKey, ttlInSeconds, entry, response, [&parsedValue](const string &) { return std::move(parsedValue); });
+			},
+			coalesced
 		);
+		if (coalesced)
+			_metrics->coalesced(api);
+	}
+	catch (...)
+	{
+		// same error of the call in flight
+		if (coalesced)
+			_metrics->coalesced(api);
+
 		throw;
 	}
+
+	return *value;
 }
 
-CatraMMSAPI::EncodersPool CatraMMSAPI::fillEncodersPool(const json& encodersPoolRoot)
+CurlConnectionPool::HttpResponse CatraMMSAPI::streamedGet(
+	const Session &session, const string &api, const string &url, const string &eTag, const function<any(istream &)> &parse, any &value
+)
 {
-	try
+	optional<chrono::milliseconds> delay = hedgeDelay(api);
+	// the body is parsed while it is received by a worker thread, in case one is idle: the threads do not grow
+	// with the calls in flight. Not for hedged or HTTP/2 calls (multiplexed with the other calls by the event loop):
+	// two requests cannot write the same pipe and the event loop does not wait for its reader
+	if (!delay && !_apiHTTP2)
 	{
-		EncodersPool encodersPool;
+		BodyPipe bodyPipe(_maxBufferedResponseBytes);
+
+		packaged_task<any()> parseTask(
+			[this, &api, &parse, &bodyPipe]() -> any
+			{
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				try
+				{
+					istream responseBody(&bodyPipe);
+					// no body (i.e. 304 or failure)
+					if (responseBody.peek() == istream::traits_type::eof())
+						return any();
+
+					any value = parse(responseBody);
+					_metrics->parsed(api, chrono::steady_clock::now() - start - bodyPipe.readerWaitDuration());
+
+					return value;
+				}
+				catch (...)
+				{
+					// the transfer is aborted
+					bodyPipe.stopReading();
 
-		encodersPool.encodersPoolKey = JsonPath(&encodersPoolRoot)["encodersPoolKey"].as<int64_t>(-1);
-		encodersPool.label = JsonPath(&encodersPoolRoot)["label"].as<string>();
+					throw;
+				}
+			}
+		);
+		future<any> parsed = parseTask.get_future();
+		auto sharedParseTask = make_shared<packaged_task<any()>>(std::move(parseTask));
+		if (workerPool()->tryPost([sharedParseTask]() { (*sharedParseTask)(); }))
 		{
-			json encodersRoot = JsonPath(&encodersPoolRoot)["encoders"].as<json>(json::array());
-			for (auto &[keyRoot, valRoot] : encodersRoot.items())
-				encodersPool.encoders.push_back(fillEncoder(valRoot));
+			CurlConnectionPool::HttpResponse response;
+			try
+			{
+				response = _connectionPool->httpGetIfNoneMatch(
+					url, _apiTimeoutInSeconds, session.authorization, apiOtherHeaders(), _apiMaxRetries, _outputToBeCompressed, eTag, api, &bodyPipe
+				);
+			}
+			catch (...)
+			{
+				bodyPipe.close();
+				parsed.wait();
+				// the transfer was aborted by a parse error, this is the error to be reported
+				if (bodyPipe.readerStopped())
+					parsed.get();
+
+				throw;
+			}
+
+			value = parsed.get();
+			if (response.httpCode != 304 && !value.has_value())
+			{
+				string errorMessage = std::format(
+					"Empty response body"
+					", url: {}",
+					url
+				);
+				SPDLOG_ERROR(errorMessage);
+
+				throw runtime_error(errorMessage);
+			}
+
+			return response;
 		}
+	}
 
-		return encodersPool;
+	// all the worker threads busy, hedged or HTTP/2: the body is parsed by this thread once received
+	CurlConnectionPool::HttpResponse response =
+		delay || _apiHTTP2 ? eventLoopGet(session, api, url, eTag, delay)
+						   : _connectionPool->httpGetIfNoneMatch(
+								 url, _apiTimeoutInSeconds, session.authorization, apiOtherHeaders(), _apiMaxRetries, _outputToBeCompressed, eTag, api
+							 );
+	if (response.httpCode != 304 && !response.body.empty())
+	{
+		CatalogSnapshot::BodyBuffer bodyBuffer(response.body);
+		istream responseBody(&bodyBuffer);
+		value = _metrics->parse(api, [&]() { return parse(responseBody); });
 	}
-	catch (exception &e)
+	if (response.httpCode != 304 && !value.has_value())
 	{
-		SPDLOG_ERROR(
-			"fillEncodersPool failed"
-			", exception: {}",
-			e.what()
+		string errorMessage = std::format(
+			"Empty response body"
+			", url: {}",
+			url
 		);
-		throw;
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	return response;
+}
+
+CurlConnectionPool::HttpResponse CatraMMSAPI::eventLoopGet(
+	const Session &session, const string &api, const string &url, const string &eTag, optional<chrono::milliseconds> hedgeDelay
+)
+{
+	CurlConnectionPool::HttpRequest request{
+		url, _apiTimeoutInSeconds, session.authorization, apiOtherHeaders(), nullopt, "", _outputToBeCompressed, true, api
+	};
+	if (!eTag.empty())
+		request.otherHeaders.push_back(std::format("If-None-Match: {}", eTag));
+
+	return eventLoop()->perform(std::move(request), _apiMaxRetries, hedgeDelay);
+}
+
+optional<chrono::milliseconds> CatraMMSAPI::hedgeDelay(const string &api) const
+{
+	if (!_hedgingEnabled)
+		return nullopt;
+
+	ApiMetrics::Histogram transferTime = _metrics->transferTime(api);
+	if (transferTime.count < _hedgingMinSamples)
+		return nullopt;
+
+	// in the +Inf bucket: no bound to wait for
+	double percentileInSeconds = transferTime.percentileInSeconds(_hedgingLatencyPercentile);
+	if (isinf(percentileInSeconds))
+		return nullopt;
+
+	return chrono::milliseconds(llround(percentileInSeconds * 1000));
+}
+
+template <typename T>
+future<T> CatraMMSAPI::cachedGetJsonAsync(
+	const Session &session, const string &api, const string &url, int32_t ttlInSeconds, bool cacheAllowed, function<T(const string &)> fill
+)
+{
+	auto promise = make_shared<std::promise<T>>();
+	future<T> result = promise->get_future();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	bool toBeCached = _cacheEnabled && ttlInSeconds > 0;
+	string cacheKey = catalogCacheKey(session, url);
+	optional<CatalogCache::Entry> entry;
+	if (toBeCached)
+	{
+		if (shared_ptr<const any> value = catalogCacheLookup(cacheKey, cacheAllowed, entry))
+		{
+			promise->set_value(any_cast<const T &>(*value));
+			_metrics->called(api, chrono::steady_clock::now() - start, false);
+
+			return result;
+		}
+		if (cacheAllowed && !entry)
+		{
+			shared_ptr<const any> snapshotValue = catalogSnapshotLookup(
+				session, api, url, cacheKey, ttlInSeconds,
+				// by value: the background revalidation calls it after this method returned
+				[fill](istream &bodyStream) -> any { return fill(string(istreambuf_iterator<char>(bodyStream), istreambuf_iterator<char>())); }
+			);
+			if (snapshotValue)
+			{
+				promise->set_value(any_cast<const T &>(*snapshotValue));
+				_metrics->called(api, chrono::steady_clock::now() - start, false);
+
+				return result;
+			}
+		}
+	}
+
+	bool inFlight = !_inFlightGets->join(
+		cacheKey,
+		[this, api, start, promise](const shared_ptr<const any> &value, exception_ptr error)
+		{
+			if (error)
+			{
+				promise->set_exception(error);
+				_metrics->called(api, chrono::steady_clock::now() - start, true);
+
+				return;
+			}
+
+			promise->set_value(any_cast<const T &>(*value));
+			_metrics->called(api, chrono::steady_clock::now() - start, false);
+		}
+	);
+	// an identical call is in flight, its value is received by the waiter
+	if (inFlight)
+	{
+		_metrics->coalesced(api);
+
+		return result;
 	}
+
+	CurlConnectionPool::HttpRequest request{
+		url, _apiTimeoutInSeconds, session.authorization, apiOtherHeaders(), nullopt, "", _outputToBeCompressed, true, api
+	};
+	if (entry && !entry->eTag.empty())
+		request.otherHeaders.push_back(std::format("If-None-Match: {}", entry->eTag));
+
+	eventLoop()->submit(
+		std::move(request), _apiMaxRetries,
+		[this, api, toBeCached, cacheKey, ttlInSeconds, entry, fill](CurlConnectionPool::HttpResponse &&response, exception_ptr error)
+		{
+			// parse and snapshot save are not done by the event loop thread, it would stop the other transfers
+			workerPool()->post(
+				[this, api, toBeCached, cacheKey, ttlInSeconds, entry, fill, response = std::move(response), error]() mutable
+				{
+					try
+					{
+						if (error)
+							rethrow_exception(error);
+
+						shared_ptr<const any> value;
+						if (!toBeCached)
+							value = make_shared<const any>(_metrics->parse(api, [&]() { return fill(response.body); }));
+						else
+						{
+							value = catalogCacheStore(
+								cacheKey, ttlInSeconds, entry, response,
+								[this, &api, &fill](const string &responseBody) -> any
+							{ return _metrics->parse(api, [&]() { return fill(responseBody); }); }
+							);
+							if (response.httpCode != 304)
+								catalogSnapshotStore(cacheKey, response.eTag, std::move(response.body));
+						}
+						_inFlightGets->completed(cacheKey, value, nullptr);
+					}
+					catch (exception &e)
+					{
+						SPDLOG_ERROR(
+							"{} failed"
+							", exception: {}",
+							api, e.what()
+						);
+						_inFlightGets->completed(cacheKey, nullptr, current_exception());
+					}
+				}
+			);
+		},
+		hedgeDelay(api)
+	);
+
+	return result;
+}
+
+template <typename T>
+future<T> CatraMMSAPI::postJsonAsync(const Session &session, const string &api, const string &url, string body, function<T(const string &)> fill)
+{
+	auto promise = make_shared<std::promise<T>>();
+	future<T> result = promise->get_future();
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	submitPostJson(
+		session, api, url, std::move(body),
+		[this, api, start, fill, promise](CurlConnectionPool::HttpResponse &&response, exception_ptr error)
+		{
+			// not parsed by the event loop thread, it would stop the other transfers
+			workerPool()->post(
+				[this, api, start, fill, promise, response = std::move(response), error]()
+				{
+					try
+					{
+						if (error)
+							rethrow_exception(error);
+
+						promise->set_value(_metrics->parse(api, [&]() { return fill(response.body); }));
+						_metrics->called(api, chrono::steady_clock::now() - start, false);
+					}
+					catch (exception &e)
+					{
+						SPDLOG_ERROR(
+							"{} failed"
+							", exception: {}",
+							api, e.what()
+						);
+						promise->set_exception(current_exception());
+						_metrics->called(api, chrono::steady_clock::now() - start, true);
+					}
+				}
+			);
+		}
+	);
+
+	return result;
+}
+
+bool CatraMMSAPI::requestBodyToBeCompressed(size_t bodySize) const
+{
+	return !_requestCompressionEncoding.empty() && !_requestCompressionRejected && bodySize >= static_cast<size_t>(_requestCompressionMinBodySizeInBytes);
 }
 
-CatraMMSAPI::Encoder CatraMMSAPI::fillEncoder(const json& encoderRoot)
+bool CatraMMSAPI::requestCompressionRejected(const exception_ptr &error)
 {
 	try
 	{
-		Encoder encoder;
+		rethrow_exception(error);
+	}
+	catch (CurlHttpError &e)
+	{
+		// 415 Unsupported Media Type: the server does not accept the Content-Encoding
+		if (e.httpCode != 415)
+			return false;
+
+		if (!_requestCompressionRejected.exchange(true))
+			LOG_WARN(
+				"Compressed request body rejected by the server, the following request bodies are not compressed"
+				", encoding: {}",
+				_requestCompressionEncoding
+			);
+
+		return true;
+	}
+	catch (...)
+	{
+		return false;
+	}
+}
 
-		encoder.encoderKey = JsonPath(&encoderRoot)["encoderKey"].as<int64_t>(-1);
-		encoder.label = JsonPath(&encoderRoot)["label"].as<string>();
-		encoder.external = JsonPath(&encoderRoot)["external"].as<bool>(false);
-		encoder.enabled = JsonPath(&encoderRoot)["enabled"].as<bool>(false);
-		encoder.protocol = JsonPath(&encoderRoot)["protocol"].as<string>();
-		encoder.publicServerName = JsonPath(&encoderRoot)["publicServerName"].as<string>();
-		encoder.internalServerName = JsonPath(&encoderRoot)["internalServerName"].as<string>();
-		encoder.port = JsonPath(&encoderRoot)["port"].as<int32_t>(-1);
-		encoder.running = JsonPath(&encoderRoot)["running"].as<bool>(false);
-		encoder.cpuUsage = JsonPath(&encoderRoot)["cpuUsage"].as<int32_t>(-1);
-		encoder.workspacesAssociatedRoot = JsonPath(&encoderRoot)["workspacesAssociated"].as<json>(json::array());
+string CatraMMSAPI::httpPostJson(const Session &session, const string &api, const string &url, string body)
+{
+	// on the event loop, multiplexed with the other calls
+	if (_apiHTTP2)
+	{
+		auto promise = make_shared<std::promise<string>>();
+		future<string> responseBody = promise->get_future();
+		submitPostJson(
+			session, api, url, std::move(body),
+			[promise](CurlConnectionPool::HttpResponse &&response, exception_ptr error)
+			{
+				if (error)
+					promise->set_exception(error);
+				else
+					promise->set_value(std::move(response.body));
+			}
+		);
 
-		return encoder;
+		return responseBody.get();
 	}
-	catch (exception &e)
+
+	if (requestBodyToBeCompressed(body.size()))
 	{
-		SPDLOG_ERROR(
-			"fillEncoder failed"
-			", exception: {}",
-			e.what()
+		try
+		{
+			return _connectionPool->httpPostString(
+				url, _apiTimeoutInSeconds, session.authorization, CurlConnectionPool::compress(body, _requestCompressionLevel), "application/json",
+				{std::format("Content-Encoding: {}", _requestCompressionEncoding)}, _apiMaxRetries, false, api
+			);
+		}
+		catch (CurlHttpError &)
+		{
+			if (!requestCompressionRejected(current_exception()))
+				throw;
+		}
+	}
+
+	return _connectionPool->httpPostString(
+		url, _apiTimeoutInSeconds, session.authorization, std::move(body), "application/json", vector<string>(), _apiMaxRetries, false, api
+	);
+}
+
+void CatraMMSAPI::submitPostJson(const Session &session, const string &api, const string &url, string body, CurlEventLoop::Completion completion)
+{
+	if (!requestBodyToBeCompressed(body.size()))
+	{
+		eventLoop()->submit(
+			{url, _apiTimeoutInSeconds, session.authorization, {}, std::move(body), "application/json", false, false, api}, _apiMaxRetries,
+			std::move(completion)
 		);
-		throw;
+
+		return;
 	}
+
+	CurlConnectionPool::HttpRequest request{
+		url, _apiTimeoutInSeconds, session.authorization, {std::format("Content-Encoding: {}", _requestCompressionEncoding)},
+		CurlConnectionPool::compress(body, _requestCompressionLevel), "application/json", false, false, api
+	};
+	// kept to be sent again in case the server rejects the compressed body
+	CurlConnectionPool::HttpRequest uncompressedRequest{
+		url, _apiTimeoutInSeconds, session.authorization, {}, std::move(body), "application/json", false, false, api
+	};
+	eventLoop()->submit(
+		std::move(request), _apiMaxRetries,
+		[this, uncompressedRequest = std::move(uncompressedRequest),
+		 completion = std::move(completion)](CurlConnectionPool::HttpResponse &&response, exception_ptr error) mutable
+		{
+			if (error && requestCompressionRejected(error))
+				eventLoop()->submit(std::move(uncompressedRequest), _apiMaxRetries, std::move(completion));
+			else
+				completion(std::move(response), error);
+		}
+	);
+}
+
+map<string, ApiMetrics::Api> CatraMMSAPI::metricsSnapshot() const { return _metrics->snapshot(); }
+
+string CatraMMSAPI::metricsPrometheus() const { return _metrics->prometheus(); }
+
+void CatraMMSAPI::saveCatalogSnapshot()
+{
+	if (_catalogSnapshot)
+		_catalogSnapshot->save();
+}
+
+shared_ptr<WorkerPool> CatraMMSAPI::workerPool()
+{
+	call_once(_workerPoolStarted, [this]() { _workerPool = make_shared<WorkerPool>(_workerThreads); });
+
+	return _workerPool;
+}
+
+shared_ptr<CurlEventLoop> CatraMMSAPI::eventLoop()
+{
+	// started only by the first asynchronous call
+	call_once(_eventLoopStarted, [this]() { _eventLoop = make_shared<CurlEventLoop>(_connectionPool); });
+
+	return _eventLoop;
 }
 
-CatraMMSAPI::RTMPChannelConf CatraMMSAPI::fillRTMPChannelConf(json rtmpChannelConfRoot)
+const CatraMMSAPI::EncodingProfileVideo &CatraMMSAPI::EncodingProfile::videoDetails() const
 {
+	if (_videoDetails)
+		return *_videoDetails;
+
 	try
 	{
-		RTMPChannelConf rtmpChannelConf;
+		EncodingProfileVideo videoDetails;
+
+		videoDetails.codec = JsonPath(&encodingProfileRoot)["video"]["codec"].as<string>("");
+		videoDetails.profile = JsonPath(&encodingProfileRoot)["video"]["profile"].as<string>("");
+		videoDetails.twoPasses = JsonPath(&encodingProfileRoot)["video"]["twoPasses"].as<bool>(false);
+		videoDetails.otherOutputParameters = JsonPath(&encodingProfileRoot)["video"]["otherOutputParameters"].as<string>("");
+		videoDetails.frameRate = JsonPath(&encodingProfileRoot)["video"]["frameRate"].as<int32_t>(-1);
+		videoDetails.keyFrameIntervalInSeconds = JsonPath(&encodingProfileRoot)["video"]["keyFrameIntervalInSeconds"].as<int32_t>(-1);
+		{
+			json bitRatesRoot = JsonPath(&encodingProfileRoot)["video"]["bitRates"].as<json>(json::array());
+			for (auto &[keyRoot, valRoot] : bitRatesRoot.items())
+			{
+				VideoBitRate videoBitRate;
+
+				videoBitRate.width = JsonPath(&valRoot)["width"].as<int32_t>(-1);
+				videoBitRate.height = JsonPath(&valRoot)["height"].as<int32_t>(-1);
+				videoBitRate.kBitRate = JsonPath(&valRoot)["kBitRate"].as<int32_t>(-1);
+				videoBitRate.forceOriginalAspectRatio = JsonPath(&valRoot)["forceOriginalAspectRatio"].as<string>("");
+				videoBitRate.pad = JsonPath(&valRoot)["pad"].as<bool>(false);
+				videoBitRate.kMaxRate = JsonPath(&valRoot)["kMaxRate"].as<int32_t>(-1);
+				videoBitRate.kBufferSize = JsonPath(&valRoot)["kBufferSize"].as<int32_t>(-1);
+
+				videoDetails.videoBitRates.push_back(videoBitRate);
+			}
+		}
 
-		rtmpChannelConf.confKey = JsonPath(&rtmpChannelConfRoot)["confKey"].as<int64_t>(-1);
-		rtmpChannelConf.label = JsonPath(&rtmpChannelConfRoot)["label"].as<string>();
-		rtmpChannelConf.rtmpURL = JsonPath(&rtmpChannelConfRoot)["rtmpURL"].as<string>();
-		rtmpChannelConf.streamName = JsonPath(&rtmpChannelConfRoot)["streamName"].as<string>();
-		rtmpChannelConf.userName = JsonPath(&rtmpChannelConfRoot)["userName"].as<string>();
-		rtmpChannelConf.password = JsonPath(&rtmpChannelConfRoot)["password"].as<string>();
-		rtmpChannelConf.playURLDetails = JsonPath(&rtmpChannelConfRoot)["playURLDetails"].as<json>(json(nullptr));
-		rtmpChannelConf.type = JsonPath(&rtmpChannelConfRoot)["type"].as<string>();
-		rtmpChannelConf.outputIndex = JsonPath(&rtmpChannelConfRoot)["outputIndex"].as<int64_t>(-1);
-		rtmpChannelConf.reservedByIngestionJobKey = JsonPath(&rtmpChannelConfRoot)["reservedByIngestionJobKey"].as<int64_t>(-1);
-		rtmpChannelConf.configurationLabel = JsonPath(&rtmpChannelConfRoot)["configurationLabel"].as<string>();
+		_videoDetails = std::move(videoDetails);
 
-		return rtmpChannelConf;
+		return *_videoDetails;
 	}
 	catch (exception &e)
 	{
 		SPDLOG_ERROR(
-			"fillRTMPChannelConf failed"
+			"videoDetails failed"
+			", encodingProfileKey: {}"
 			", exception: {}",
-			e.what()
+			encodingProfileKey, e.what()
 		);
 		throw;
 	}
 }
 
-CatraMMSAPI::SRTChannelConf CatraMMSAPI::fillSRTChannelConf(const json& srtChannelConfRoot)
+const CatraMMSAPI::EncodingProfileAudio &CatraMMSAPI::EncodingProfile::audioDetails() const
 {
+	if (_audioDetails)
+		return *_audioDetails;
+
 	try
 	{
-		SRTChannelConf srtChannelConf;
+		EncodingProfileAudio audioDetails;
+
+		audioDetails.codec = JsonPath(&encodingProfileRoot)["audio"]["codec"].as<string>("");
+		audioDetails.otherOutputParameters = JsonPath(&encodingProfileRoot)["audio"]["otherOutputParameters"].as<string>("");
+		audioDetails.channelsNumber = JsonPath(&encodingProfileRoot)["audio"]["channelsNumber"].as<int16_t>(-1);
+		audioDetails.sampleRate = JsonPath(&encodingProfileRoot)["audio"]["sampleRate"].as<int32_t>(-1);
+		{
+			json bitRatesRoot = JsonPath(&encodingProfileRoot)["audio"]["bitRates"].as<json>(json::array());
+			for (auto &[keyRoot, valRoot] : bitRatesRoot.items())
+				audioDetails.kBitRates.push_back(JsonPath(&valRoot)["kBitRate"].as<int32_t>(-1));
+		}
 
-		srtChannelConf.confKey = JsonPath(&srtChannelConfRoot)["confKey"].as<int64_t>(-1);
-		srtChannelConf.label = JsonPath(&srtChannelConfRoot)["label"].as<string>();
-		srtChannelConf.srtURL = JsonPath(&srtChannelConfRoot)["srtURL"].as<string>();
-		srtChannelConf.mode = JsonPath(&srtChannelConfRoot)["mode"].as<string>("caller");
-		srtChannelConf.streamId = JsonPath(&srtChannelConfRoot)["streamId"].as<string>();
-		srtChannelConf.passphrase = JsonPath(&srtChannelConfRoot)["passphrase"].as<string>();
-		srtChannelConf.playURL = JsonPath(&srtChannelConfRoot)["playURL"].as<string>();
-		srtChannelConf.type = JsonPath(&srtChannelConfRoot)["type"].as<string>();
-		srtChannelConf.outputIndex = JsonPath(&srtChannelConfRoot)["outputIndex"].as<int64_t>(-1);
-		srtChannelConf.reservedByIngestionJobKey = JsonPath(&srtChannelConfRoot)["reservedByIngestionJobKey"].as<int64_t>(-1);
-		srtChannelConf.configurationLabel = JsonPath(&srtChannelConfRoot)["configurationLabel"].as<string>();
+		_audioDetails = std::move(audioDetails);
 
-		return srtChannelConf;
+		return *_audioDetails;
 	}
 	catch (exception &e)
 	{
 		SPDLOG_ERROR(
-			"fillSRTChannelConf failed"
+			"audioDetails failed"
+			", encodingProfileKey: {}"
 			", exception: {}",
-			e.what()
+			encodingProfileKey, e.what()
 		);
 		throw;
 	}
 }
 
-CatraMMSAPI::Stream CatraMMSAPI::fillStream(const json& streamRoot)
+const CatraMMSAPI::EncodingProfileImage &CatraMMSAPI::EncodingProfile::imageDetails() const
 {
+	if (_imageDetails)
+		return *_imageDetails;
+
 	try
 	{
-		Stream stream;
-
-		stream.confKey = JsonPath(&streamRoot)["confKey"].as<int64_t>(-1);
-		stream.label = JsonPath(&streamRoot)["label"].as<string>();
-		stream.sourceType = JsonPath(&streamRoot)["sourceType"].as<string>();
-		stream.encodersPoolKey = JsonPath(&streamRoot)["encodersPoolKey"].as<int64_t>(-1);
-		stream.encodersPoolLabel = JsonPath(&streamRoot)["encodersPoolLabel"].as<string>();
-		stream.url = JsonPath(&streamRoot)["url"].as<string>();
-		stream.pushProtocol = JsonPath(&streamRoot)["pushProtocol"].as<string>();
-		stream.pushEncoderKey = JsonPath(&streamRoot)["pushEncoderKey"].as<int64_t>(-1);
-		stream.pushPublicEncoderName = JsonPath(&streamRoot)["pushPublicEncoderName"].as<bool>(false);
-		stream.pushEncoderLabel = JsonPath(&streamRoot)["pushEncoderLabel"].as<string>();
-		stream.pushEncoderName = JsonPath(&streamRoot)["pushEncoderName"].as<string>();
-		stream.pushServerPort = JsonPath(&streamRoot)["pushServerPort"].as<int16_t>(-1);
-		stream.pushURI = JsonPath(&streamRoot)["pushUri"].as<string>();
-		stream.pushListenTimeout = JsonPath(&streamRoot)["pushListenTimeout"].as<int16_t>(-1);
-		stream.captureLiveVideoDeviceNumber = JsonPath(&streamRoot)["captureLiveVideoDeviceNumber"].as<int16_t>(-1);
-		stream.captureLiveVideoInputFormat = JsonPath(&streamRoot)["captureLiveVideoInputFormat"].as<string>();
-		stream.captureLiveFrameRate = JsonPath(&streamRoot)["captureLiveFrameRate"].as<int16_t>(-1);
-		stream.captureLiveWidth = JsonPath(&streamRoot)["captureLiveWidth"].as<int16_t>(-1);
-		stream.captureLiveHeight = JsonPath(&streamRoot)["captureLiveHeight"].as<int16_t>(-1);
-		stream.captureLiveAudioDeviceNumber = JsonPath(&streamRoot)["captureLiveAudioDeviceNumber"].as<int16_t>(-1);
-		stream.captureLiveChannelsNumber = JsonPath(&streamRoot)["captureLiveChannelsNumber"].as<int16_t>(-1);
-		stream.tvSourceTVConfKey = JsonPath(&streamRoot)["tvSourceTVConfKey"].as<int64_t>(-1);
-		stream.type = JsonPath(&streamRoot)["type"].as<string>();
-		stream.description = JsonPath(&streamRoot)["description"].as<string>();
-		stream.name = JsonPath(&streamRoot)["name"].as<string>();
-		stream.region = JsonPath(&streamRoot)["region"].as<string>();
-		stream.country = JsonPath(&streamRoot)["country"].as<string>();
-		stream.imageMediaItemKey = JsonPath(&streamRoot)["imageMediaItemKey"].as<int64_t>(-1);
-		stream.imageUniqueName = JsonPath(&streamRoot)["imageUniqueName"].as<string>();
-		stream.position = JsonPath(&streamRoot)["position"].as<int16_t>(-1);
-		stream.userData = JsonPath(&streamRoot)["userData"].as<string>();
-
-		return stream;
+		EncodingProfileImage imageDetails;
+
+		imageDetails.width = JsonPath(&encodingProfileRoot)["image"]["width"].as<int32_t>(-1);
+		imageDetails.height = JsonPath(&encodingProfileRoot)["image"]["height"].as<int32_t>(-1);
+		imageDetails.aspectRatio = JsonPath(&encodingProfileRoot)["image"]["aspectRatio"].as<bool>(false);
+		imageDetails.maxWidth = JsonPath(&encodingProfileRoot)["image"]["maxWidth"].as<int32_t>(-1);
+		imageDetails.maxHeight = JsonPath(&encodingProfileRoot)["image"]["maxHeight"].as<int32_t>(-1);
+		imageDetails.interlaceType = JsonPath(&encodingProfileRoot)["image"]["interlaceType"].as<string>("");
+
+		_imageDetails = std::move(imageDetails);
+
+		return *_imageDetails;
 	}
 	catch (exception &e)
 	{
 		SPDLOG_ERROR(
-			"fillStream failed"
+			"imageDetails failed"
+			", encodingProfileKey: {}"
 			", exception: {}",
-			e.what()
+			encodingProfileKey, e.what()
 		);
 		throw;
 	}
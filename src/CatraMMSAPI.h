@@ -1,9 +1,29 @@
 
 #pragma once
 
+#include "ApiMetrics.h"
+#include "CatalogCache.h"
+#include "CurlConnectionPool.h"
+#include "CurlEventLoop.h"
+#include "JsonSaxReader.h"
+#include "UploadJournal.h"
 #include "JSONUtils.h"
 #include "spdlog/spdlog.h"
 
+#include <any>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <optional>
+
+class CatalogSnapshot;
+class EncoderPoolMonitor;
+class SingleFlight;
+class StreamCatalog;
+class WorkerPool;
+
 class CatraMMSAPI
 {
 	struct UserProfile
@@ -106,6 +126,23 @@ class CatraMMSAPI
 		int64_t key;
 		std::string label;
 	};
+	// result of one workflow of ingestionWorkflowBatch
+	struct IngestionWorkflowBatchResult
+	{
+		std::pair<IngestionResult, std::vector<IngestionResult>> ingestionResults;
+		std::exception_ptr error; // not null in case the workflow failed
+	};
+	// state of a login, never changed: a new login replaces the whole session
+	struct Session
+	{
+		UserProfile userProfile;
+		WorkspaceDetails workspaceDetails;
+		std::string mmsVersion;
+
+		std::string authorization; // Basic of userKey and apiKey
+		std::string apiURL;		   // <protocol>://<hostname>:<port>/catramms/1.0.1
+		std::string binaryURL;
+	};
 	struct VideoBitRate
 	{
 		int32_t width;
@@ -152,10 +189,20 @@ class CatraMMSAPI
 		std::string contentType;
 		std::string fileFormat;
 		std::string description;
-		EncodingProfileVideo videoDetails;
-		EncodingProfileAudio audioDetails;
-		EncodingProfileImage imageDetails;
 		nlohmann::json encodingProfileRoot;
+
+		// the details are decoded from encodingProfileRoot on first access and then kept in the object,
+		// they are not decoded again in case encodingProfileRoot is changed later.
+		// Not thread safe, as the other structs: the getters return a copy of the profiles to every caller
+		// and a profile read by more threads (also only by the const accessors) has to be synchronized by the caller
+		const EncodingProfileVideo &videoDetails() const;
+		const EncodingProfileAudio &audioDetails() const;
+		const EncodingProfileImage &imageDetails() const;
+
+	  private:
+		mutable std::optional<EncodingProfileVideo> _videoDetails;
+		mutable std::optional<EncodingProfileAudio> _audioDetails;
+		mutable std::optional<EncodingProfileImage> _imageDetails;
 	};
 	struct Encoder
 	{
@@ -249,11 +296,75 @@ class CatraMMSAPI
 		int16_t captureLiveAudioDeviceNumber;
 		int16_t captureLiveChannelsNumber;
 		int64_t tvSourceTVConfKey;
+
+		bool operator==(const Stream &) const = default;
+	};
+
+	// All the streams matching the filters of getAllStreams, requested page by page while they are iterated:
+	// the next page is requested (getStreamsAsync) while the caller goes through the current one
+	class StreamsRange
+	{
+	  public:
+		using PageFetcher = std::function<std::future<std::pair<std::vector<Stream>, int64_t>>(int32_t startIndex, int32_t pageSize)>;
+
+		class Iterator
+		{
+		  public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = Stream;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Stream *;
+			using reference = const Stream &;
+
+			Iterator() : _range(nullptr) {}
+			explicit Iterator(StreamsRange *range) : _range(range) {}
+
+			reference operator*() const { return _range->_page[_range->_pageIndex]; }
+			pointer operator->() const { return &_range->_page[_range->_pageIndex]; }
+			Iterator &operator++()
+			{
+				_range->next();
+				return *this;
+			}
+			void operator++(int) { _range->next(); }
+			bool operator==(std::default_sentinel_t) const { return _range == nullptr || _range->atEnd(); }
+
+		  private:
+			StreamsRange *_range;
+		};
+
+		StreamsRange(PageFetcher pageFetcher, int32_t pageSize);
+
+		// single pass, the first call requests the first page
+		Iterator begin();
+		std::default_sentinel_t end() const { return std::default_sentinel; }
+
+		// numFound returned by the server, it waits the first page if not yet received
+		int64_t total();
+
+	  private:
+		PageFetcher _pageFetcher;
+		int32_t _pageSize;
+
+		bool _started;
+		int64_t _total;
+		int64_t _nextStartIndex;
+		std::future<std::pair<std::vector<Stream>, int64_t>> _nextPage;
+
+		std::vector<Stream> _page;
+		size_t _pageIndex;
+
+		void start();
+		void fetchNextPage();
+		void loadNextPage();
+		void next();
+		bool atEnd() const { return _pageIndex >= _page.size(); }
 	};
 
 	explicit CatraMMSAPI(nlohmann::json &configurationRoot);
-	~CatraMMSAPI() = default;
+	~CatraMMSAPI();
 
+	// copies of the last session, not thread safe: in case the instance is shared among threads use session()
 	UserProfile userProfile;
 	WorkspaceDetails currentWorkspaceDetails;
 	std::string mmsVersion;
@@ -262,15 +373,26 @@ class CatraMMSAPI
 	std::vector<std::string> audioFileFormats;
 	std::vector<std::string> imageFileFormats;
 
+	// clientIPAddress empty: the configured or looked up one (mms->clientIPAddress), login waits for the lookup only a short deadline
 	void login(std::string userName, std::string password, std::string clientIPAddress = "");
+	// session of the last successful login, nullptr before it. Thread safe, the API calls of many threads share it
+	std::shared_ptr<const Session> session() const;
 	std::vector<EncodingProfile> getEncodingProfiles(std::string contentType, int64_t encodingProfileKey = -1, std::string label = "", bool cacheAllowed = true);
 	std::vector<EncodersPool> getEncodersPool(bool cacheAllowed = true);
+	// encoders pools refreshed in background (mms->encoderPoolMonitor), started by the first call (after login).
+	// It is stopped when this instance is destroyed: a monitor kept later returns the last snapshot and refresh() throws
+	std::shared_ptr<EncoderPoolMonitor> encoderPoolMonitor();
 	std::vector<EncodingProfilesSet> getEncodingProfilesSets(std::string contentType, bool cacheAllowed = true);
 	std::vector<RTMPChannelConf> getRTMPChannelConf(std::string label = "", bool labelLike = true, std::string type = "", bool cacheAllowed = true);
 	std::vector<SRTChannelConf> getSRTChannelConf(const std::string& label = "", bool labelLike = true, const std::string& type = "", bool cacheAllowed = true);
 	std::pair<IngestionResult, std::vector<IngestionResult>> ingestionWorkflow(nlohmann::json workflowRoot);
+	// the workflows are submitted keeping up to maxConcurrency of them in flight (one connection each), the results are in the
+	// order of workflowRoots and a failed workflow does not stop the others. progress(completed, total) is called by the calling thread
+	std::vector<IngestionWorkflowBatchResult> ingestionWorkflowBatch(
+		const std::vector<nlohmann::json> &workflowRoots, int maxConcurrency = 8, const std::function<void(int64_t, int64_t)> &progress = nullptr
+	);
 	void ingestionBinary(int64_t addContentIngestionJobKey, const std::string& pathFileName, std::function<bool(int, int)> chunkCompleted);
-	std::pair<std::vector<Stream>, int16_t> getStreams(
+	std::pair<std::vector<Stream>, int64_t> getStreams(
 		std::optional<int> startIndex = std::nullopt, std::optional<int> pageSize = std::nullopt, std::optional<int64_t> confKey = std::nullopt,
 		std::optional<std::string> label = std::nullopt, std::optional<bool> labelLike = std::nullopt, std::optional<std::string> url = std::nullopt,
 		std::optional<std::string> sourceType = std::nullopt, std::optional<std::string> type = std::nullopt,
@@ -278,15 +400,68 @@ class CatraMMSAPI
 		std::optional<std::string> country = std::nullopt, const std::string &labelOrder = "asc", bool cacheAllowed = true
 	);
 
+	// walks all the matching streams, pageSize streams every request
+	StreamsRange getAllStreams(
+		int32_t pageSize = 100, std::optional<int64_t> confKey = std::nullopt, std::optional<std::string> label = std::nullopt,
+		std::optional<bool> labelLike = std::nullopt, std::optional<std::string> url = std::nullopt,
+		std::optional<std::string> sourceType = std::nullopt, std::optional<std::string> type = std::nullopt,
+		std::optional<std::string> name = std::nullopt, std::optional<std::string> region = std::nullopt,
+		std::optional<std::string> country = std::nullopt, const std::string &labelOrder = "asc"
+	);
+	// local replica of all the streams, queried without requests to the server, synced in background (mms->streamCatalog).
+	// It is started by the first call (after login) and stopped when this instance is destroyed: a catalog kept later
+	// returns the last synced streams and sync() throws
+	std::shared_ptr<StreamCatalog> streamCatalog();
+
+	// Non-blocking variants: the HTTP calls of all of them are multiplexed by a single event loop thread
+	// (started by the first call), the returned future is set once the response is received and parsed
+	std::future<std::vector<EncodingProfile>>
+	getEncodingProfilesAsync(std::string contentType, int64_t encodingProfileKey = -1, std::string label = "", bool cacheAllowed = true);
+	std::future<std::vector<EncodersPool>> getEncodersPoolAsync(bool cacheAllowed = true);
+	std::future<std::vector<EncodingProfilesSet>> getEncodingProfilesSetsAsync(std::string contentType, bool cacheAllowed = true);
+	std::future<std::vector<RTMPChannelConf>>
+	getRTMPChannelConfAsync(std::string label = "", bool labelLike = true, std::string type = "", bool cacheAllowed = true);
+	std::future<std::vector<SRTChannelConf>>
+	getSRTChannelConfAsync(const std::string &label = "", bool labelLike = true, const std::string &type = "", bool cacheAllowed = true);
+	std::future<std::pair<IngestionResult, std::vector<IngestionResult>>> ingestionWorkflowAsync(nlohmann::json workflowRoot);
+	std::future<std::pair<std::vector<Stream>, int64_t>> getStreamsAsync(
+		std::optional<int> startIndex = std::nullopt, std::optional<int> pageSize = std::nullopt, std::optional<int64_t> confKey = std::nullopt,
+		std::optional<std::string> label = std::nullopt, std::optional<bool> labelLike = std::nullopt, std::optional<std::string> url = std::nullopt,
+		std::optional<std::string> sourceType = std::nullopt, std::optional<std::string> type = std::nullopt,
+		std::optional<std::string> name = std::nullopt, std::optional<std::string> region = std::nullopt,
+		std::optional<std::string> country = std::nullopt, const std::string &labelOrder = "asc", bool cacheAllowed = true
+	);
+
+	// per API (the Async variants are separated) latency, retries, bytes sent/received, decompression and parse time
+	std::map<std::string, ApiMetrics::Api> metricsSnapshot() const;
+	// the same metrics in the Prometheus text format
+	std::string metricsPrometheus() const;
+
+	// writes the catalogs received so far in the snapshot (mms->api->cache->snapshotPathFileName), it is done
+	// anyway every snapshotSaveIntervalInSeconds and by the destructor
+	void saveCatalogSnapshot();
+
   private:
-	bool _loginSuccessful;
-	std::string _userName;
-	std::string _password;
+	// benchmark/CatraMMSAPIBenchmark.cpp measures the parse* and *URL methods
+	friend class CatraMMSAPIBenchmark;
+	// syncs its replica page by page (streamsURL, streamedGet)
+	friend class StreamCatalog;
+
+	// swapped by login, every API call loads it once and uses it until its end
+	std::atomic<std::shared_ptr<const Session>> _session;
 
 	int32_t _apiTimeoutInSeconds;
 	int32_t _apiMaxRetries;
 	int32_t _statisticsTimeoutInSeconds;
 	int32_t _deliveryMaxRetries;
+	int32_t _retryInitialBackoffInMilliSeconds;
+	int32_t _retryMaxBackoffInMilliSeconds;
+	double _retryBackoffMultiplier;
+	int32_t _retryBudgetWindowInSeconds;
+	double _retryBudgetRatio;
+	int32_t _retryBudgetMinRetries;
+	int32_t _circuitBreakerFailureThreshold;
+	int32_t _circuitBreakerOpenInSeconds;
 	bool _httpVerbose;
 	std::string _httpSSLVersion;
 	std::string _proxyURL;
@@ -295,21 +470,175 @@ class CatraMMSAPI
 	std::string _apiProtocol;
 	std::string _apiHostname;
 	int32_t _apiPort;
+	bool _apiHTTP2;
 	std::string _binaryProtocol;
 	std::string _binaryHostname;
 	int32_t _binaryPort;
+	std::string _apiURL;
+	std::string _binaryURL;
 	int32_t _binaryTimeoutInSeconds;
 	int32_t _binaryMaxRetries;
+	int32_t _binaryMaxChunksInFlight;
+	int64_t _binaryInitialChunkSizeInBytes;
+	int64_t _binaryMinChunkSizeInBytes;
+	int64_t _binaryMaxChunkSizeInBytes;
+	int64_t _binaryTargetChunkDurationInSeconds;
+	int64_t _binaryMaxBytesPerSecond;
+	std::string _binaryUploadJournalDirectory;
+	bool _binaryMemoryMappedUpload;
 	bool _outputToBeCompressed;
+	int32_t _maxBufferedResponseBytes;
+	std::string _requestCompressionEncoding;
+	int32_t _requestCompressionMinBodySizeInBytes;
+	int32_t _requestCompressionLevel;
+	// set once the server rejected (415) a compressed body, the following bodies are sent uncompressed
+	std::atomic<bool> _requestCompressionRejected;
+	int32_t _maxIdleConnectionsPerHost;
+	std::string _clientIPAddress;
+	std::string _clientIPAddressLookupURL;
+	int32_t _clientIPAddressLookupTimeoutInSeconds;
+	int32_t _clientIPAddressLookupDeadlineInMilliSeconds;
+	int32_t _encoderPoolMonitorRefreshIntervalInSeconds;
+	int32_t _streamCatalogRefreshIntervalInSeconds;
+	int32_t _streamCatalogPageSize;
+
+	// connections kept alive toward _apiHostname and _binaryHostname
+	std::shared_ptr<CurlConnectionPool> _connectionPool;
+
+	bool _cacheEnabled;
+	int32_t _cacheMaxEntries;
+	int32_t _encodingProfilesCacheTTLInSeconds;
+	int32_t _encodingProfilesSetsCacheTTLInSeconds;
+	int32_t _encodersPoolCacheTTLInSeconds;
+	int32_t _rtmpChannelConfCacheTTLInSeconds;
+	int32_t _srtChannelConfCacheTTLInSeconds;
+	std::shared_ptr<CatalogCache> _catalogCache;
+	std::string _cacheSnapshotPathFileName;
+	int32_t _cacheSnapshotSaveIntervalInSeconds;
+	// catalogs saved by the previous process, used by the first lookup of a key and revalidated in background
+	std::shared_ptr<CatalogSnapshot> _catalogSnapshot;
+	bool _hedgingEnabled;
+	double _hedgingLatencyPercentile;
+	int32_t _hedgingMinSamples;
+	// identical concurrent catalog GETs (same workspace and url) share one request and its parsed value
+	std::shared_ptr<SingleFlight> _inFlightGets;
+	std::shared_ptr<ApiMetrics> _metrics;
+	int32_t _workerThreads;
+
+	// parses the responses received by the event loop, started by the first call needing it.
+	// Declared before the event loop: the completions of the transfers aborted by its destructor post here
+	std::once_flag _workerPoolStarted;
+	std::shared_ptr<WorkerPool> _workerPool;
+
+	std::shared_ptr<WorkerPool> workerPool();
+
+	// started by the first asynchronous call
+	std::once_flag _eventLoopStarted;
+	std::shared_ptr<CurlEventLoop> _eventLoop;
+
+	std::shared_ptr<CurlEventLoop> eventLoop();
+
+	// started on the event loop by the first login without clientIPAddress, its result is used by all the following ones
+	std::once_flag _clientIPAddressLookupStarted;
+	std::shared_future<std::string> _clientIPAddressLookup;
 
-	static UserProfile fillUserProfile(const nlohmann::json& userProfileRoot);
-	static WorkspaceDetails fillWorkspaceDetails(const nlohmann::json &workspacedetailsRoot);
-	static EncodingProfile fillEncodingProfile(const nlohmann::json& encodingProfileRoot, bool deep);
-	static EncodingProfilesSet fillEncodingProfilesSet(const nlohmann::json& encodingProfilesSetRoot, bool deep);
-	static EncodersPool fillEncodersPool(const nlohmann::json& encodersPoolRoot);
-	static Encoder fillEncoder(const nlohmann::json& encoderRoot);
-	RTMPChannelConf fillRTMPChannelConf(nlohmann::json rtmpChannelConfRoot);
-	static SRTChannelConf fillSRTChannelConf(const nlohmann::json& srtChannelConfRoot);
-	static Stream fillStream(const nlohmann::json& streamRoot);
+	// declared after the members it uses: it is destroyed (its thread stopped) first
+	std::mutex _encoderPoolMonitorMutex;
+	std::shared_ptr<EncoderPoolMonitor> _encoderPoolMonitor;
+	std::mutex _streamCatalogMutex;
+	std::shared_ptr<StreamCatalog> _streamCatalog;
+
+	void startClientIPAddressLookup();
+	// configured or looked up IP, empty in case the lookup failed or is not completed within the deadline
+	std::string lookedUpClientIPAddress();
+
+	std::vector<std::string> apiOtherHeaders() const;
+
+	std::string encodingProfilesURL(
+		const Session &session, const std::string &contentType, int64_t encodingProfileKey, const std::string &label, bool cacheAllowed
+	) const;
+	std::string encodingProfilesSetsURL(const Session &session, const std::string &contentType, bool cacheAllowed) const;
+	std::string encodersPoolURL(const Session &session, bool cacheAllowed) const;
+	std::string
+	rtmpChannelConfURL(const Session &session, const std::string &label, bool labelLike, const std::string &type, bool cacheAllowed) const;
+	std::string
+	srtChannelConfURL(const Session &session, const std::string &label, bool labelLike, const std::string &type, bool cacheAllowed) const;
+	std::string streamsURL(
+		const Session &session, const std::optional<int32_t> &startIndex, const std::optional<int32_t> &pageSize,
+		const std::optional<int64_t> &confKey, const std::optional<std::string> &label, const std::optional<bool> &labelLike,
+		const std::optional<std::string> &url, const std::optional<std::string> &sourceType, const std::optional<std::string> &type,
+		const std::optional<std::string> &name, const std::optional<std::string> &region, const std::optional<std::string> &country,
+		const std::string &labelOrder, bool cacheAllowed
+	) const;
+
+	// the responses are parsed by SAX targets (CatraMMSAPI.cpp) straight into the structs
+	struct SaxTargets;
+	// false in case the response has no workspace
+	static bool parseLogin(const std::string &responseBody, UserProfile &userProfile, WorkspaceDetails &workspaceDetails, std::string &mmsVersion);
+	static std::pair<IngestionResult, std::vector<IngestionResult>> parseIngestionWorkflow(const std::string &responseBody);
+	// the catalogs are parsed from the whole body or while it is received (see streamedGet)
+	static std::vector<EncodingProfile> parseEncodingProfiles(const JsonSaxReader::Input &responseBody);
+	static std::vector<EncodingProfilesSet> parseEncodingProfilesSets(const JsonSaxReader::Input &responseBody);
+	static std::vector<EncodersPool> parseEncodersPool(const JsonSaxReader::Input &responseBody);
+	static std::vector<RTMPChannelConf> parseRTMPChannelConfs(const JsonSaxReader::Input &responseBody);
+	static std::vector<SRTChannelConf> parseSRTChannelConfs(const JsonSaxReader::Input &responseBody);
+	static std::pair<std::vector<Stream>, int64_t> parseStreams(const JsonSaxReader::Input &responseBody);
+
+	std::string catalogCacheKey(const Session &session, const std::string &url) const;
+	// value still valid or nullptr, in this last case entry is the expired one (if any) to be revalidated
+	std::shared_ptr<const std::any> catalogCacheLookup(const std::string &cacheKey, bool cacheAllowed, std::optional<CatalogCache::Entry> &entry);
+	std::shared_ptr<const std::any> catalogCacheStore(
+		const std::string &cacheKey, int32_t ttlInSeconds, const std::optional<CatalogCache::Entry> &entry,
+		const CurlConnectionPool::HttpResponse &response, const std::function<std::any(const std::string &)> &fill
+	);
+
+	// value parsed from the snapshot, in case it has cacheKey, and revalidated in background.
+	// fill is copied and called again by the revalidation, it must not refer to the locals of the caller
+	std::shared_ptr<const std::any> catalogSnapshotLookup(
+		const Session &session, const std::string &api, const std::string &url, const std::string &cacheKey, int32_t ttlInSeconds,
+		const std::function<std::any(std::istream &)> &fill
+	);
+	void catalogSnapshotStore(const std::string &cacheKey, const std::string &eTag, std::string body);
+
+	// GET of a catalog: the structs filled by fill are returned from the cache while still valid (ttlInSeconds),
+	// then the entry is revalidated by the server (ETag)
+	std::any cachedGetJson(
+		const Session &session, const std::string &api, const std::string &url, int32_t ttlInSeconds, bool cacheAllowed,
+		const std::function<std::any(std::istream &)> &fill
+	);
+	// GET (If-None-Match in case eTag is not empty) whose body is parsed by parse, by an idle worker thread, while it is received:
+	// at most _maxBufferedResponseBytes of the body are in memory. In case all the worker threads are busy, and in case of
+	// hedging or HTTP/2 (see eventLoopGet), the whole body is received and then parsed by the calling thread.
+	// value is not set in case of 304
+	CurlConnectionPool::HttpResponse streamedGet(
+		const Session &session, const std::string &api, const std::string &url, const std::string &eTag,
+		const std::function<std::any(std::istream &)> &parse, std::any &value
+	);
+	// GET on the event loop (body in HttpResponse::body), sent again in case it is not answered within hedgeDelay:
+	// the first response wins
+	CurlConnectionPool::HttpResponse eventLoopGet(
+		const Session &session, const std::string &api, const std::string &url, const std::string &eTag,
+		std::optional<std::chrono::milliseconds> hedgeDelay
+	);
+	// percentile (mms->api->hedging) of the transfer time of api, nullopt in case hedging is disabled or not enough transfers were measured
+	std::optional<std::chrono::milliseconds> hedgeDelay(const std::string &api) const;
+	template <typename T>
+	std::future<T> cachedGetJsonAsync(
+		const Session &session, const std::string &api, const std::string &url, int32_t ttlInSeconds, bool cacheAllowed,
+		std::function<T(const std::string &)> fill
+	);
+	// POST of a json body, compressed (mms->api->requestCompression) in case it is large enough
+	// and sent again uncompressed in case the server rejects it
+	std::string httpPostJson(const Session &session, const std::string &api, const std::string &url, std::string body);
+	void submitPostJson(
+		const Session &session, const std::string &api, const std::string &url, std::string body, CurlEventLoop::Completion completion
+	);
+	bool requestBodyToBeCompressed(size_t bodySize) const;
+	// true in case error is the server rejecting the compressed body
+	bool requestCompressionRejected(const std::exception_ptr &error);
+	template <typename T>
+	std::future<T> postJsonAsync(
+		const Session &session, const std::string &api, const std::string &url, std::string body, std::function<T(const std::string &)> fill
+	);
 
 };
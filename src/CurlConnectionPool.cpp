@@ -0,0 +1,1104 @@
+#include "CurlConnectionPool.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <strings.h>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <zlib.h>
+
+using namespace std;
+using json = nlohmann::json;
+
+struct CurlConnectionPool::BodyReceiver
+{
+	CURL *handle;
+	bool compressed;
+	BodyPipe *bodyPipe;
+
+	bool started = false;	 // first chunk received
+	bool successful = false; // 2xx: inflated and/or written in the pipe, otherwise the body is kept as it is
+	z_stream zs{};
+	bool inflating = false;
+	bool finished = false; // end of the compressed body
+	string errorMessage;
+	chrono::steady_clock::duration inflateDuration{};
+
+	BodyReceiver(CURL *handle, bool compressed, BodyPipe *bodyPipe) : handle(handle), compressed(compressed), bodyPipe(bodyPipe) {}
+	~BodyReceiver()
+	{
+		if (inflating)
+			inflateEnd(&zs);
+	}
+
+	// false in case the transfer has to be aborted
+	bool output(HttpResponse &response, const char *data, size_t length)
+	{
+		if (bodyPipe == nullptr)
+		{
+			response.body.append(data, length);
+
+			return true;
+		}
+		if (!bodyPipe->write(data, length))
+		{
+			errorMessage = "the reader of the body stopped reading";
+
+			return false;
+		}
+
+		return true;
+	}
+};
+
+CurlConnectionPool::Lease::~Lease()
+{
+	if (_handle != nullptr)
+		_pool->release(_origin, _handle);
+}
+
+CurlConnectionPool::Lease::Lease(Lease &&other) noexcept : _pool(other._pool), _origin(std::move(other._origin)), _handle(other._handle)
+{
+	other._handle = nullptr;
+}
+
+CurlConnectionPool::CurlConnectionPool(
+	string proxyURL, string proxyUsername, string proxyPassword, string sslVersion, bool verbose, int32_t maxIdleHandlesPerOrigin,
+	bool memoryMappedUpload, shared_ptr<ApiMetrics> metrics, shared_ptr<RetryPolicy> retryPolicy, string http2Origin,
+	shared_ptr<UploadPacer> uploadPacer
+)
+	: _proxyURL(std::move(proxyURL)), _proxyUsername(std::move(proxyUsername)), _proxyPassword(std::move(proxyPassword)),
+	  _sslVersion(std::move(sslVersion)), _verbose(verbose), _maxIdleHandlesPerOrigin(maxIdleHandlesPerOrigin),
+	  _memoryMappedUpload(memoryMappedUpload), _metrics(std::move(metrics)),
+	  _retryPolicy(retryPolicy ? std::move(retryPolicy) : make_shared<RetryPolicy>()), _http2Origin(std::move(http2Origin)),
+	  _uploadPacer(uploadPacer ? std::move(uploadPacer) : make_shared<UploadPacer>())
+{
+	static once_flag curlGlobalInitialized;
+	call_once(curlGlobalInitialized, []() { curl_global_init(CURL_GLOBAL_ALL); });
+
+	_share = curl_share_init();
+	if (_share == nullptr)
+	{
+		string errorMessage = "curl_share_init failed";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+	curl_share_setopt(_share, CURLSHOPT_LOCKFUNC, lockShare);
+	curl_share_setopt(_share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+	curl_share_setopt(_share, CURLSHOPT_USERDATA, this);
+	curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	// the connection cache is not shared: libcurl does not support connections used by concurrent threads.
+	// An easy handle keeps its connection between the blocking calls, the multi handles keep their own
+}
+
+CurlConnectionPool::~CurlConnectionPool()
+{
+	{
+		lock_guard<mutex> locker(_idleHandlesMutex);
+		for (auto &[origin, handles] : _idleHandles)
+			for (CURL *handle : handles)
+				curl_easy_cleanup(handle);
+		_idleHandles.clear();
+	}
+	curl_share_cleanup(_share);
+}
+
+string CurlConnectionPool::origin(const string &url)
+{
+	// scheme://host:port/path... -> scheme://host:port
+	size_t schemeEnd = url.find("://");
+	size_t pathStart = url.find_first_of("/?", schemeEnd == string::npos ? 0 : schemeEnd + 3);
+
+	return pathStart == string::npos ? url : url.substr(0, pathStart);
+}
+
+CurlConnectionPool::Lease CurlConnectionPool::acquire(const string &url)
+{
+	string urlOrigin = origin(url);
+
+	{
+		lock_guard<mutex> locker(_idleHandlesMutex);
+
+		auto it = _idleHandles.find(urlOrigin);
+		if (it != _idleHandles.end() && !it->second.empty())
+		{
+			CURL *handle = it->second.back();
+			it->second.pop_back();
+
+			// reset the options but not the live connection and the caches
+			curl_easy_reset(handle);
+			curl_easy_setopt(handle, CURLOPT_SHARE, _share);
+
+			return {this, urlOrigin, handle};
+		}
+	}
+
+	CURL *handle = curl_easy_init();
+	if (handle == nullptr)
+	{
+		string errorMessage = std::format(
+			"curl_easy_init failed"
+			", url: {}",
+			url
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+	curl_easy_setopt(handle, CURLOPT_SHARE, _share);
+
+	return {this, urlOrigin, handle};
+}
+
+void CurlConnectionPool::release(const string &origin, CURL *handle)
+{
+	{
+		lock_guard<mutex> locker(_idleHandlesMutex);
+
+		vector<CURL *> &handles = _idleHandles[origin];
+		if (handles.size() < static_cast<size_t>(_maxIdleHandlesPerOrigin))
+		{
+			handles.push_back(handle);
+
+			return;
+		}
+	}
+
+	curl_easy_cleanup(handle);
+}
+
+void CurlConnectionPool::setCommonOptions(CURL *handle, const string &url, long timeoutInSeconds) const
+{
+	curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+	curl_easy_setopt(handle, CURLOPT_TIMEOUT, timeoutInSeconds);
+	curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+	curl_easy_setopt(handle, CURLOPT_VERBOSE, _verbose ? 1L : 0L);
+
+	if (!_proxyURL.empty())
+	{
+		curl_easy_setopt(handle, CURLOPT_PROXY, _proxyURL.c_str());
+		if (!_proxyUsername.empty())
+			curl_easy_setopt(handle, CURLOPT_PROXYUSERNAME, _proxyUsername.c_str());
+		if (!_proxyPassword.empty())
+			curl_easy_setopt(handle, CURLOPT_PROXYPASSWORD, _proxyPassword.c_str());
+	}
+
+	if (!_http2Origin.empty() && origin(url) == _http2Origin)
+	{
+		// negotiated by TLS (ALPN), HTTP/1.1 in case of http or of a server not supporting HTTP/2
+		curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+		// a new transfer waits for the connection being established, to be multiplexed on it, instead of opening another one
+		curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+	}
+
+	if (_sslVersion == "TLSv1.0")
+		curl_easy_setopt(handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_0);
+	else if (_sslVersion == "TLSv1.1")
+		curl_easy_setopt(handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_1);
+	else if (_sslVersion == "TLSv1.2")
+		curl_easy_setopt(handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_2);
+	else if (_sslVersion == "TLSv1.3")
+		curl_easy_setopt(handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_3);
+}
+
+curl_slist *CurlConnectionPool::prepare(CURL *handle, const HttpRequest &request, HttpResponse &response) const
+{
+	setCommonOptions(handle, request.url, request.timeoutInSeconds);
+
+	curl_slist *headersList = nullptr;
+	if (!request.authorization.empty())
+		headersList = curl_slist_append(headersList, std::format("Authorization: {}", request.authorization).c_str());
+	if (request.body && !request.contentType.empty())
+		headersList = curl_slist_append(headersList, std::format("Content-Type: {}", request.contentType).c_str());
+	for (const string &header : request.otherHeaders)
+		headersList = curl_slist_append(headersList, header.c_str());
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headersList);
+
+	if (request.body)
+	{
+		curl_easy_setopt(handle, CURLOPT_POST, 1L);
+		curl_easy_setopt(handle, CURLOPT_POSTFIELDS, request.body->data());
+		curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body->size()));
+	}
+	else
+		curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+
+	// the compressed body is never kept in memory, it is inflated chunk by chunk while it is received
+	// and, in case of bodyPipe, handed to its reader
+	if (request.outputCompressed || request.bodyPipe != nullptr)
+		response.bodyReceiver = make_shared<BodyReceiver>(handle, request.outputCompressed, request.bodyPipe);
+	curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, responseWriteCallback);
+	curl_easy_setopt(handle, CURLOPT_WRITEDATA, &response);
+	curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, eTagHeaderCallback);
+	curl_easy_setopt(handle, CURLOPT_HEADERDATA, &response.eTag);
+
+	return headersList;
+}
+
+void CurlConnectionPool::complete(CURL *handle, CURLcode curlCode, const HttpRequest &request, curl_slist *headersList, HttpResponse &response) const
+{
+	// the list has not to be referenced anymore once the handle is back to the pool
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, nullptr);
+	curl_slist_free_all(headersList);
+
+	// failed attempts included
+	recordTransfer(handle, request.api);
+
+	shared_ptr<BodyReceiver> bodyReceiver = std::move(response.bodyReceiver);
+	if (bodyReceiver && !bodyReceiver->errorMessage.empty())
+	{
+		string errorMessage = std::format(
+			"receiving the body failed"
+			", url: {}"
+			", error: {}",
+			request.url, bodyReceiver->errorMessage
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	response.httpCode = checkResponse(handle, curlCode, request.url, response.body, request.notModifiedAccepted);
+
+	if (bodyReceiver && bodyReceiver->inflating)
+	{
+		if (!bodyReceiver->finished)
+		{
+			string errorMessage = std::format(
+				"inflate failed, compressed body truncated"
+				", url: {}",
+				request.url
+			);
+			SPDLOG_ERROR(errorMessage);
+
+			throw runtime_error(errorMessage);
+		}
+		if (_metrics)
+			_metrics->decompressed(request.api, bodyReceiver->inflateDuration);
+	}
+}
+
+void CurlConnectionPool::recordTransfer(CURL *handle, const string &api) const
+{
+	if (!_metrics || api.empty())
+		return;
+
+	long requestSize = 0;
+	long headerSize = 0;
+	curl_off_t uploadSize = 0;
+	curl_off_t downloadSize = 0;
+	curl_easy_getinfo(handle, CURLINFO_REQUEST_SIZE, &requestSize);
+	curl_easy_getinfo(handle, CURLINFO_HEADER_SIZE, &headerSize);
+	curl_easy_getinfo(handle, CURLINFO_SIZE_UPLOAD_T, &uploadSize);
+	curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &downloadSize);
+	curl_off_t totalTimeInMicroSeconds = 0;
+	curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &totalTimeInMicroSeconds);
+
+	_metrics->transferred(api, requestSize + uploadSize, headerSize + downloadSize, chrono::microseconds(totalTimeInMicroSeconds));
+}
+
+void CurlConnectionPool::measureChunk(CURL *handle, const ChunkUpload &chunkUpload) const
+{
+	curl_off_t totalTimeInMicroSeconds = 0;
+	curl_off_t nameLookupTimeInMicroSeconds = 0;
+	curl_off_t connectTimeInMicroSeconds = 0;
+	curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &totalTimeInMicroSeconds);
+	curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &nameLookupTimeInMicroSeconds);
+	curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connectTimeInMicroSeconds);
+
+	// TCP handshake, zero in case the connection was reused
+	curl_off_t handshakeInMicroSeconds = max<curl_off_t>(connectTimeInMicroSeconds - nameLookupTimeInMicroSeconds, 0);
+
+	_uploadPacer->measured(
+		chunkUpload.contentRangeEnd_Excluded - chunkUpload.contentRangeStart, chrono::microseconds(totalTimeInMicroSeconds),
+		chrono::microseconds(handshakeInMicroSeconds)
+	);
+}
+
+CurlConnectionPool::HttpResponse CurlConnectionPool::perform(const HttpRequest &request)
+{
+	Lease lease = acquire(request.url);
+	CURL *handle = lease.handle();
+
+	HttpResponse response;
+	curl_slist *headersList = prepare(handle, request, response);
+
+	CURLcode curlCode = curl_easy_perform(handle);
+
+	complete(handle, curlCode, request, headersList, response);
+
+	return response;
+}
+
+long CurlConnectionPool::checkResponse(CURL *handle, CURLcode curlCode, const string &url, const string &response, bool notModifiedAccepted)
+{
+	if (curlCode != CURLE_OK)
+	{
+		string errorMessage = std::format(
+			"curl_easy_perform failed"
+			", url: {}"
+			", curlCode: {}"
+			", curlError: {}",
+			url, static_cast<int>(curlCode), curl_easy_strerror(curlCode)
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	long httpCode;
+	curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &httpCode);
+	if ((httpCode < 200 || httpCode >= 300) && !(notModifiedAccepted && httpCode == 304))
+	{
+		string errorMessage = std::format(
+			"HTTP call failed"
+			", url: {}"
+			", httpCode: {}"
+			", response: {}",
+			url, httpCode, response
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw CurlHttpError(httpCode, errorMessage);
+	}
+
+	return httpCode;
+}
+
+bool CurlConnectionPool::isRetryable(const exception_ptr &error)
+{
+	try
+	{
+		rethrow_exception(error);
+	}
+	catch (CurlHttpError &e)
+	{
+		// a client error will not change retrying
+		return e.httpCode >= 500;
+	}
+	catch (CircuitOpenError &)
+	{
+		return false;
+	}
+	catch (...)
+	{
+		return true;
+	}
+}
+
+CurlConnectionPool::HttpResponse CurlConnectionPool::performWithRetries(const HttpRequest &request, int maxRetryNumber)
+{
+	int retryNumber = 0;
+	while (true)
+	{
+		optional<chrono::milliseconds> retryDelay;
+		try
+		{
+			_retryPolicy->admit(request.url);
+			HttpResponse response = perform(request);
+			_retryPolicy->succeeded(request.url);
+			if (request.bodyPipe != nullptr)
+				request.bodyPipe->close();
+
+			return response;
+		}
+		catch (CircuitOpenError &)
+		{
+			if (request.bodyPipe != nullptr)
+				request.bodyPipe->close();
+
+			throw;
+		}
+		catch (exception &e)
+		{
+			bool retryable = isRetryable(current_exception());
+			if (retryable)
+				_retryPolicy->failed(request.url);
+			else
+				_retryPolicy->succeeded(request.url);
+
+			// the body already handed to the reader of the pipe cannot be received again
+			bool bodyPiped = request.bodyPipe != nullptr && request.bodyPipe->written();
+			if (retryNumber < maxRetryNumber && retryable && !bodyPiped)
+				retryDelay = _retryPolicy->retryDelay(request.url, retryNumber + 1);
+			if (!retryDelay)
+			{
+				// the reader gets EOF
+				if (request.bodyPipe != nullptr)
+					request.bodyPipe->close();
+
+				throw;
+			}
+		}
+
+		retryNumber++;
+		if (_metrics)
+			_metrics->retried(request.api);
+		LOG_WARN(
+			"HTTP call failed, retrying"
+			", url: {}"
+			", retryNumber: {}"
+			", maxRetryNumber: {}"
+			", retryDelay (millisecs): {}",
+			request.url, retryNumber, maxRetryNumber, retryDelay->count()
+		);
+		this_thread::sleep_for(*retryDelay);
+	}
+}
+
+string CurlConnectionPool::httpGet(
+	const string &url, long timeoutInSeconds, const string &authorization, const vector<string> &otherHeaders, int maxRetryNumber,
+	bool outputCompressed, const string &api
+)
+{
+	HttpRequest request{url, timeoutInSeconds, authorization, otherHeaders, nullopt, "", outputCompressed, false, api};
+	HttpResponse response = performWithRetries(request, maxRetryNumber);
+
+	return response.body;
+}
+
+CurlConnectionPool::HttpResponse CurlConnectionPool::httpGetIfNoneMatch(
+	const string &url, long timeoutInSeconds, const string &authorization, const vector<string> &otherHeaders, int maxRetryNumber,
+	bool outputCompressed, const string &eTag, const string &api, BodyPipe *bodyPipe
+)
+{
+	HttpRequest request{url, timeoutInSeconds, authorization, otherHeaders, nullopt, "", outputCompressed, true, api, bodyPipe};
+	if (!eTag.empty())
+		request.otherHeaders.push_back(std::format("If-None-Match: {}", eTag));
+
+	return performWithRetries(request, maxRetryNumber);
+}
+
+json CurlConnectionPool::httpGetJson(
+	const string &url, long timeoutInSeconds, const string &authorization, const vector<string> &otherHeaders, int maxRetryNumber,
+	bool outputCompressed, const string &api
+)
+{
+	string response = httpGet(url, timeoutInSeconds, authorization, otherHeaders, maxRetryNumber, outputCompressed, api);
+
+	return JSONUtils::toJson<json>(response);
+}
+
+string CurlConnectionPool::httpPostString(
+	const string &url, long timeoutInSeconds, const string &authorization, string body, const string &contentType, const vector<string> &otherHeaders,
+	int maxRetryNumber, bool outputCompressed, const string &api
+)
+{
+	HttpRequest request{url, timeoutInSeconds, authorization, otherHeaders, std::move(body), contentType, outputCompressed, false, api};
+	HttpResponse response = performWithRetries(request, maxRetryNumber);
+
+	return response.body;
+}
+
+json CurlConnectionPool::httpPostStringAndGetJson(
+	const string &url, long timeoutInSeconds, const string &authorization, string body, const string &contentType, const vector<string> &otherHeaders,
+	int maxRetryNumber, bool outputCompressed, const string &api
+)
+{
+	string response = httpPostString(
+		url, timeoutInSeconds, authorization, std::move(body), contentType, otherHeaders, maxRetryNumber, outputCompressed, api
+	);
+
+	return JSONUtils::toJson<json>(response);
+}
+
+string CurlConnectionPool::httpPostFileSplittingInChunks(
+	const string &url, long timeoutInSeconds, const string &authorization, const string &pathFileName,
+	const function<bool(int, int, int64_t)> &chunkCompleted, int maxRetryNumber, int maxChunksInFlight, int firstChunkIndex, int64_t firstChunkStart,
+	const string &api
+)
+{
+	int64_t fileSize = filesystem::file_size(pathFileName);
+
+	if (maxChunksInFlight < 1)
+		maxChunksInFlight = 1;
+	// an empty file is sent anyway, as a single empty chunk
+	if (fileSize > 0 && firstChunkStart >= fileSize)
+	{
+		LOG_INFO(
+			"All the chunks were already uploaded"
+			", url: {}"
+			", pathFileName: {}"
+			", fileSize: {}",
+			url, pathFileName, fileSize
+		);
+
+		return "";
+	}
+	firstChunkIndex = max(firstChunkIndex, 0);
+	firstChunkStart = clamp<int64_t>(firstChunkStart, 0, fileSize);
+
+	CURLM *multi = curl_multi_init();
+	if (multi == nullptr)
+	{
+		string errorMessage = "curl_multi_init failed";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	// chunks being uploaded and chunks waiting for their retry
+	unordered_map<CURL *, unique_ptr<ChunkUpload>> running;
+	multimap<chrono::steady_clock::time_point, unique_ptr<ChunkUpload>> toBeRetried;
+	// chunks uploaded (response, end of the chunk) but not yet acknowledged because a previous chunk is still in flight
+	map<int, pair<string, int64_t>> uploaded;
+
+	const shared_ptr<UploadBandwidthCap> &bandwidthCap = _uploadPacer->bandwidthCap();
+	int nextChunkToBeSent = firstChunkIndex;
+	int64_t nextChunkStart = firstChunkStart;
+	// the chunks not yet sent are estimated with the current chunk size
+	auto chunksNumber = [&]()
+	{
+		int64_t chunkSize = _uploadPacer->chunkSize();
+
+		return nextChunkToBeSent + static_cast<int>((fileSize - nextChunkStart + chunkSize - 1) / chunkSize);
+	};
+
+	auto stopRunningChunks = [&]()
+	{
+		for (auto &[handle, chunkUpload] : running)
+			stopFileRange(multi, *chunkUpload);
+		running.clear();
+		curl_multi_cleanup(multi);
+	};
+
+	string response;
+	try
+	{
+		int nextChunkToBeAcknowledged = firstChunkIndex;
+		bool lastChunkSent = false;
+		bool lastChunkAcknowledged = false;
+		bool uploadToBeStopped = false;
+		while (true)
+		{
+			int runningHandles;
+			curl_multi_perform(multi, &runningHandles);
+
+			CURLMsg *message;
+			int messagesInQueue;
+			while ((message = curl_multi_info_read(multi, &messagesInQueue)) != nullptr)
+			{
+				if (message->msg != CURLMSG_DONE)
+					continue;
+
+				auto it = running.find(message->easy_handle);
+				if (it == running.end())
+					continue;
+				unique_ptr<ChunkUpload> chunkUpload = std::move(it->second);
+				running.erase(it);
+
+				// message is not valid anymore once the handle is removed from multi
+				CURLcode curlCode = message->data.result;
+				stopFileRange(multi, *chunkUpload);
+				recordTransfer(chunkUpload->lease->handle(), api);
+
+				try
+				{
+					checkResponse(chunkUpload->lease->handle(), curlCode, url, chunkUpload->response);
+					measureChunk(chunkUpload->lease->handle(), *chunkUpload);
+					chunkUpload->lease.reset();
+					_retryPolicy->succeeded(url);
+				}
+				catch (exception &e)
+				{
+					chunkUpload->lease.reset();
+					bool retryable = isRetryable(current_exception());
+					if (retryable)
+						_retryPolicy->failed(url);
+					else
+						_retryPolicy->succeeded(url);
+
+					optional<chrono::milliseconds> retryDelay;
+					if (chunkUpload->retryNumber < maxRetryNumber && retryable)
+						retryDelay = _retryPolicy->retryDelay(url, chunkUpload->retryNumber + 1);
+					if (!retryDelay)
+						throw;
+
+					chunkUpload->retryNumber++;
+					if (_metrics)
+						_metrics->retried(api);
+					LOG_WARN(
+						"Chunk upload failed, retrying"
+						", url: {}"
+						", chunkIndex: {}"
+						", chunksNumber: {}"
+						", retryNumber: {}"
+						", maxRetryNumber: {}"
+						", retryDelay (millisecs): {}",
+						url, chunkUpload->chunkIndex, chunksNumber(), chunkUpload->retryNumber, maxRetryNumber, retryDelay->count()
+					);
+					auto retryTime = chrono::steady_clock::now() + *retryDelay;
+					toBeRetried.emplace(retryTime, std::move(chunkUpload));
+
+					continue;
+				}
+
+				uploaded[chunkUpload->chunkIndex] = {std::move(chunkUpload->response), chunkUpload->contentRangeEnd_Excluded};
+			}
+
+			// chunkCompleted is called in chunk order
+			while (!uploadToBeStopped && !uploaded.empty() && uploaded.begin()->first == nextChunkToBeAcknowledged)
+			{
+				response = std::move(uploaded.begin()->second.first);
+				int64_t uploadedBytes = uploaded.begin()->second.second;
+				uploaded.erase(uploaded.begin());
+				int chunkIndex = nextChunkToBeAcknowledged++;
+				lastChunkAcknowledged = uploadedBytes == fileSize;
+
+				if (chunkCompleted != nullptr && chunkCompleted(chunkIndex, chunksNumber(), uploadedBytes))
+				{
+					LOG_INFO(
+						"Upload stopped by the caller"
+						", url: {}"
+						", chunkIndex: {}"
+						", uploadedBytes: {}"
+						", fileSize: {}",
+						url, chunkIndex, uploadedBytes, fileSize
+					);
+
+					uploadToBeStopped = true;
+				}
+			}
+			if (uploadToBeStopped || lastChunkAcknowledged)
+				break;
+
+			chrono::steady_clock::time_point now = chrono::steady_clock::now();
+			while (!toBeRetried.empty() && toBeRetried.begin()->first <= now)
+			{
+				unique_ptr<ChunkUpload> chunkUpload = std::move(toBeRetried.begin()->second);
+				toBeRetried.erase(toBeRetried.begin());
+
+				startFileRange(multi, *chunkUpload, url, timeoutInSeconds, authorization, pathFileName, fileSize);
+				CURL *handle = chunkUpload->lease->handle();
+				running[handle] = std::move(chunkUpload);
+			}
+
+			// the last chunk lets the server consider the file complete, it is sent once all the previous chunks are uploaded
+			while (!lastChunkSent && running.size() + toBeRetried.size() < static_cast<size_t>(maxChunksInFlight))
+			{
+				// the size of every new chunk follows the throughput measured so far
+				int64_t chunkEnd = min(nextChunkStart + _uploadPacer->chunkSize(), fileSize);
+				if (chunkEnd == fileSize && nextChunkToBeAcknowledged < nextChunkToBeSent)
+					break;
+
+				auto chunkUpload = make_unique<ChunkUpload>();
+				chunkUpload->chunkIndex = nextChunkToBeSent;
+				chunkUpload->retryNumber = 0;
+				chunkUpload->contentRangeStart = nextChunkStart;
+				chunkUpload->contentRangeEnd_Excluded = chunkEnd;
+				chunkUpload->headersList = nullptr;
+				chunkUpload->mappedAddress = nullptr;
+				chunkUpload->mappedLength = 0;
+				chunkUpload->releasedLength = 0;
+
+				startFileRange(multi, *chunkUpload, url, timeoutInSeconds, authorization, pathFileName, fileSize);
+				CURL *handle = chunkUpload->lease->handle();
+				running[handle] = std::move(chunkUpload);
+				nextChunkToBeSent++;
+				nextChunkStart = chunkEnd;
+				lastChunkSent = chunkEnd == fileSize;
+			}
+
+			// the share of the bandwidth cap follows the chunks in flight of all the uploads of the process,
+			// UploadBandwidthCap wakes this loop up once it changes (0: the cap was removed)
+			curl_off_t sendSpeed = bandwidthCap->sendSpeed();
+			for (auto &[handle, chunkUpload] : running)
+				curl_easy_setopt(handle, CURLOPT_MAX_SEND_SPEED_LARGE, sendSpeed);
+
+			// wake up in time for the first retry
+			int timeoutInMilliSeconds = 1000;
+			if (!toBeRetried.empty())
+			{
+				auto untilFirstRetry = chrono::duration_cast<chrono::milliseconds>(toBeRetried.begin()->first - chrono::steady_clock::now()).count();
+				timeoutInMilliSeconds = static_cast<int>(clamp<int64_t>(untilFirstRetry, 0, timeoutInMilliSeconds));
+			}
+			curl_multi_poll(multi, nullptr, 0, timeoutInMilliSeconds, nullptr);
+		}
+	}
+	catch (exception &e)
+	{
+		stopRunningChunks();
+
+		throw;
+	}
+	stopRunningChunks();
+
+	return response;
+}
+
+void CurlConnectionPool::startFileRange(
+	CURLM *multi, ChunkUpload &chunkUpload, const string &url, long timeoutInSeconds, const string &authorization, const string &pathFileName,
+	int64_t fileSize
+)
+{
+	_retryPolicy->admit(url);
+
+	chunkUpload.response.clear();
+
+	chunkUpload.lease.emplace(acquire(url));
+	CURL *handle = chunkUpload.lease->handle();
+
+	int64_t chunkLength = chunkUpload.contentRangeEnd_Excluded - chunkUpload.contentRangeStart;
+	if (_memoryMappedUpload)
+		mapFileRange(chunkUpload, pathFileName);
+	else
+	{
+		if (!chunkUpload.fileStream.is_open())
+		{
+			chunkUpload.fileStream.open(pathFileName, ios::binary);
+			if (!chunkUpload.fileStream)
+			{
+				string errorMessage = std::format(
+					"Failed to open the file to be uploaded"
+					", pathFileName: {}",
+					pathFileName
+				);
+				SPDLOG_ERROR(errorMessage);
+
+				throw runtime_error(errorMessage);
+			}
+		}
+		chunkUpload.fileStream.clear();
+		chunkUpload.fileStream.seekg(chunkUpload.contentRangeStart);
+		chunkUpload.uploadSource = UploadSource{&chunkUpload.fileStream, chunkLength};
+	}
+
+	setCommonOptions(handle, url, timeoutInSeconds);
+
+	curl_slist *headersList = nullptr;
+	if (!authorization.empty())
+		headersList = curl_slist_append(headersList, std::format("Authorization: {}", authorization).c_str());
+	// no Content-Range in case the whole file is sent in one chunk
+	if (chunkUpload.contentRangeStart > 0 || chunkUpload.contentRangeEnd_Excluded < fileSize)
+		headersList = curl_slist_append(
+			headersList,
+			std::format("Content-Range: bytes {}-{}/{}", chunkUpload.contentRangeStart, chunkUpload.contentRangeEnd_Excluded - 1, fileSize).c_str()
+		);
+	headersList = curl_slist_append(headersList, "Content-Type: application/octet-stream");
+	// no 100-continue round trip before every chunk
+	headersList = curl_slist_append(headersList, "Expect:");
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headersList);
+	chunkUpload.headersList = headersList;
+
+	curl_easy_setopt(handle, CURLOPT_POST, 1L);
+	curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(chunkLength));
+	if (_memoryMappedUpload)
+	{
+		// libcurl sends from the mapping, no copy in user space
+		int64_t alignmentOffset = chunkUpload.mappedLength - chunkLength;
+		curl_easy_setopt(handle, CURLOPT_POSTFIELDS, static_cast<char *>(chunkUpload.mappedAddress) + alignmentOffset);
+		// the pages already sent are released while the upload goes on, the memory used does not depend on the chunk size
+		curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, releaseUploadedPagesCallback);
+		curl_easy_setopt(handle, CURLOPT_XFERINFODATA, &chunkUpload);
+		curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+	}
+	else
+	{
+		curl_easy_setopt(handle, CURLOPT_READFUNCTION, readCallback);
+		curl_easy_setopt(handle, CURLOPT_READDATA, &chunkUpload.uploadSource);
+	}
+
+	curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, writeCallback);
+	curl_easy_setopt(handle, CURLOPT_WRITEDATA, &chunkUpload.response);
+
+	CURLMcode curlMCode = curl_multi_add_handle(multi, handle);
+	if (curlMCode != CURLM_OK)
+	{
+		curl_easy_setopt(handle, CURLOPT_HTTPHEADER, nullptr);
+		curl_slist_free_all(chunkUpload.headersList);
+		chunkUpload.headersList = nullptr;
+		chunkUpload.lease.reset();
+		if (chunkUpload.mappedAddress != nullptr)
+		{
+			munmap(chunkUpload.mappedAddress, chunkUpload.mappedLength);
+			chunkUpload.mappedAddress = nullptr;
+		}
+
+		string errorMessage = std::format(
+			"curl_multi_add_handle failed"
+			", url: {}"
+			", curlMCode: {}",
+			url, curl_multi_strerror(curlMCode)
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	// libcurl keeps the chunk under its share of the bandwidth cap, without stopping the other transfers
+	_uploadPacer->bandwidthCap()->chunkStarted(multi);
+	curl_easy_setopt(handle, CURLOPT_MAX_SEND_SPEED_LARGE, static_cast<curl_off_t>(_uploadPacer->bandwidthCap()->sendSpeed()));
+}
+
+void CurlConnectionPool::stopFileRange(CURLM *multi, ChunkUpload &chunkUpload)
+{
+	CURL *handle = chunkUpload.lease->handle();
+	curl_multi_remove_handle(multi, handle);
+	_uploadPacer->bandwidthCap()->chunkStopped(multi);
+
+	// the list has not to be referenced anymore once the handle is back to the pool
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, nullptr);
+	curl_slist_free_all(chunkUpload.headersList);
+	chunkUpload.headersList = nullptr;
+
+	// a retry maps the chunk again, meanwhile its pages do not weigh on the process
+	if (chunkUpload.mappedAddress != nullptr)
+	{
+		curl_easy_setopt(handle, CURLOPT_POSTFIELDS, nullptr);
+		munmap(chunkUpload.mappedAddress, chunkUpload.mappedLength);
+		chunkUpload.mappedAddress = nullptr;
+	}
+}
+
+void CurlConnectionPool::mapFileRange(ChunkUpload &chunkUpload, const string &pathFileName) const
+{
+	int fd = open(pathFileName.c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		string errorMessage = std::format(
+			"Failed to open the file to be uploaded"
+			", pathFileName: {}"
+			", errno: {}",
+			pathFileName, errno
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	// mmap offset has to be a multiple of the page size
+	static const int64_t pageSize = sysconf(_SC_PAGESIZE);
+	int64_t mappingStart = (chunkUpload.contentRangeStart / pageSize) * pageSize;
+	size_t mappedLength = chunkUpload.contentRangeEnd_Excluded - mappingStart;
+
+	void *mappedAddress = mmap(nullptr, mappedLength, PROT_READ, MAP_SHARED, fd, mappingStart);
+	int mmapErrno = errno;
+	close(fd);
+	if (mappedAddress == MAP_FAILED)
+	{
+		string errorMessage = std::format(
+			"mmap failed"
+			", pathFileName: {}"
+			", mappingStart: {}"
+			", mappedLength: {}"
+			", errno: {}",
+			pathFileName, mappingStart, mappedLength, mmapErrno
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+	madvise(mappedAddress, mappedLength, MADV_SEQUENTIAL);
+
+	chunkUpload.mappedAddress = mappedAddress;
+	chunkUpload.mappedLength = mappedLength;
+	chunkUpload.releasedLength = 0;
+}
+
+string CurlConnectionPool::compress(const string &uncompressed, int level)
+{
+	z_stream zs{};
+	// 15 + 16: gzip header and trailer
+	if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		string errorMessage = std::format(
+			"deflateInit2 failed"
+			", level: {}",
+			level
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(uncompressed.data()));
+	zs.avail_in = static_cast<uInt>(uncompressed.size());
+
+	string compressed;
+	compressed.resize(deflateBound(&zs, zs.avail_in));
+	zs.next_out = reinterpret_cast<Bytef *>(compressed.data());
+	zs.avail_out = static_cast<uInt>(compressed.size());
+
+	// the output buffer is large enough for a single call
+	int ret = deflate(&zs, Z_FINISH);
+	if (ret != Z_STREAM_END)
+	{
+		deflateEnd(&zs);
+
+		string errorMessage = std::format(
+			"deflate failed"
+			", ret: {}",
+			ret
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+	compressed.resize(zs.total_out);
+
+	deflateEnd(&zs);
+
+	return compressed;
+}
+
+void CurlConnectionPool::lockShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+	static_cast<CurlConnectionPool *>(userptr)->_shareMutexes[data].lock();
+}
+
+void CurlConnectionPool::unlockShare(CURL *handle, curl_lock_data data, void *userptr)
+{
+	static_cast<CurlConnectionPool *>(userptr)->_shareMutexes[data].unlock();
+}
+
+size_t CurlConnectionPool::readCallback(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+	auto *uploadSource = static_cast<UploadSource *>(userdata);
+
+	size_t toBeRead = min<int64_t>(size * nitems, uploadSource->remaining);
+	if (toBeRead == 0)
+		return 0;
+
+	uploadSource->fileStream->read(buffer, toBeRead);
+	size_t read = uploadSource->fileStream->gcount();
+	if (read == 0)
+		return CURL_READFUNC_ABORT;
+	uploadSource->remaining -= read;
+
+	return read;
+}
+
+int CurlConnectionPool::releaseUploadedPagesCallback(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+{
+	auto *chunkUpload = static_cast<ChunkUpload *>(clientp);
+	if (chunkUpload->mappedAddress == nullptr)
+		return 0;
+
+	static const size_t pageSize = sysconf(_SC_PAGESIZE);
+	size_t alignmentOffset = chunkUpload->mappedLength - (chunkUpload->contentRangeEnd_Excluded - chunkUpload->contentRangeStart);
+	size_t uploadedLength = ((alignmentOffset + ulnow) / pageSize) * pageSize;
+	if (uploadedLength > chunkUpload->releasedLength)
+	{
+		// read only file mapping, in case of need the pages are just read again from the file
+		madvise(
+			static_cast<char *>(chunkUpload->mappedAddress) + chunkUpload->releasedLength, uploadedLength - chunkUpload->releasedLength, MADV_DONTNEED
+		);
+		chunkUpload->releasedLength = uploadedLength;
+	}
+
+	return 0;
+}
+
+size_t CurlConnectionPool::writeCallback(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	static_cast<string *>(userdata)->append(ptr, size * nmemb);
+
+	return size * nmemb;
+}
+
+size_t CurlConnectionPool::responseWriteCallback(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	auto *response = static_cast<HttpResponse *>(userdata);
+	size_t length = size * nmemb;
+
+	BodyReceiver *bodyReceiver = response->bodyReceiver.get();
+	if (bodyReceiver == nullptr)
+	{
+		response->body.append(ptr, length);
+
+		return length;
+	}
+
+	if (!bodyReceiver->started)
+	{
+		bodyReceiver->started = true;
+
+		long httpCode = 0;
+		curl_easy_getinfo(bodyReceiver->handle, CURLINFO_RESPONSE_CODE, &httpCode);
+		bodyReceiver->successful = httpCode >= 200 && httpCode < 300;
+		if (bodyReceiver->successful && bodyReceiver->compressed)
+		{
+			// 15 + 32: zlib or gzip header automatically detected
+			if (inflateInit2(&bodyReceiver->zs, 15 + 32) != Z_OK)
+			{
+				bodyReceiver->errorMessage = "inflateInit2 failed";
+
+				return 0; // the transfer is aborted
+			}
+			bodyReceiver->inflating = true;
+		}
+	}
+	// i.e. the error message of the server
+	if (!bodyReceiver->successful)
+	{
+		response->body.append(ptr, length);
+
+		return length;
+	}
+	if (!bodyReceiver->inflating)
+		return bodyReceiver->output(*response, ptr, length) ? length : 0;
+	if (bodyReceiver->finished)
+		return length;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	bodyReceiver->zs.next_in = reinterpret_cast<Bytef *>(ptr);
+	bodyReceiver->zs.avail_in = static_cast<uInt>(length);
+
+	char buffer[32768];
+	do
+	{
+		bodyReceiver->zs.next_out = reinterpret_cast<Bytef *>(buffer);
+		bodyReceiver->zs.avail_out = sizeof(buffer);
+
+		int ret = inflate(&bodyReceiver->zs, Z_NO_FLUSH);
+		if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+		{
+			bodyReceiver->errorMessage = std::format("inflate returned {}", ret);
+
+			return 0; // the transfer is aborted
+		}
+
+		if (!bodyReceiver->output(*response, buffer, sizeof(buffer) - bodyReceiver->zs.avail_out))
+			return 0;
+
+		if (ret == Z_STREAM_END)
+		{
+			bodyReceiver->finished = true;
+			break;
+		}
+	} while (bodyReceiver->zs.avail_out == 0);
+
+	// the time waiting for the reader of the pipe is included
+	bodyReceiver->inflateDuration += chrono::steady_clock::now() - start;
+
+	return length;
+}
+
+size_t CurlConnectionPool::eTagHeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+	string_view header(buffer, size * nitems);
+	if (header.size() > 5 && strncasecmp(header.data(), "etag:", 5) == 0)
+	{
+		header.remove_prefix(5);
+		while (!header.empty() && (header.front() == ' ' || header.front() == '\t'))
+			header.remove_prefix(1);
+		while (!header.empty() && (header.back() == '\r' || header.back() == '\n' || header.back() == ' '))
+			header.remove_suffix(1);
+		*static_cast<string *>(userdata) = header;
+	}
+
+	return size * nitems;
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include "ApiMetrics.h"
+#include "BodyPipe.h"
+#include "RetryPolicy.h"
+#include "UploadPacer.h"
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// failure reported by the server (HTTP status not 2xx)
+class CurlHttpError : public std::runtime_error
+{
+  public:
+	CurlHttpError(long httpCode, const std::string &errorMessage) : std::runtime_error(errorMessage), httpCode(httpCode) {}
+
+	long httpCode;
+};
+
+// Pool of libcurl easy handles kept alive between the calls.
+// Every easy handle keeps its own connection open (keep-alive) and all the handles share
+// DNS cache and TLS sessions, so a new call to an host already contacted does not pay again
+// DNS resolution and the full TLS handshake. The transfers driven by a multi handle (event loop)
+// use the connections kept by that multi handle
+class CurlConnectionPool
+{
+  public:
+	// easy handle borrowed from the pool, it is given back (with its open connection) when the Lease is destroyed
+	class Lease
+	{
+	  public:
+		Lease(CurlConnectionPool *pool, std::string origin, CURL *handle) : _pool(pool), _origin(std::move(origin)), _handle(handle) {}
+		~Lease();
+
+		Lease(const Lease &) = delete;
+		Lease &operator=(const Lease &) = delete;
+		Lease(Lease &&other) noexcept;
+		Lease &operator=(Lease &&other) = delete;
+
+		CURL *handle() const { return _handle; }
+
+	  private:
+		CurlConnectionPool *_pool;
+		std::string _origin;
+		CURL *_handle;
+	};
+
+	struct HttpRequest
+	{
+		std::string url;
+		long timeoutInSeconds;
+		std::string authorization;
+		std::vector<std::string> otherHeaders;
+		std::optional<std::string> body; // POST in case it is present
+		std::string contentType;
+		bool outputCompressed;
+		bool notModifiedAccepted;
+		std::string api; // metrics label, the transfer is not recorded in case it is empty
+		// the 2xx body is written here, while it is received, instead of HttpResponse::body
+		// (blocking calls only, the pipe is closed once the call is finished)
+		BodyPipe *bodyPipe = nullptr;
+	};
+	// state of a body inflated and/or piped while it is received (defined in CurlConnectionPool.cpp)
+	struct BodyReceiver;
+	struct HttpResponse
+	{
+		long httpCode;
+		std::string body;
+		std::string eTag;
+
+		// set by prepare in case of outputCompressed or bodyPipe
+		std::shared_ptr<BodyReceiver> bodyReceiver;
+	};
+
+	// memoryMappedUpload: the file chunks are mapped in memory and libcurl sends them straight from the page cache,
+	// otherwise they are read (copied) through a read callback.
+	// metrics (optional) records retries, bytes sent/received and decompression time of the requests having an api.
+	// retryPolicy decides the wait before every retry and if the retry is done at all (nullptr: RetryPolicy defaults).
+	// http2Origin (scheme://host:port, see origin): its requests use HTTP/2 and the ones started by the same multi handle
+	// (i.e. CurlEventLoop) are multiplexed on one connection.
+	// uploadPacer decides the chunk size and the bandwidth of the chunked uploads (nullptr: UploadPacer defaults)
+	CurlConnectionPool(
+		std::string proxyURL, std::string proxyUsername, std::string proxyPassword, std::string sslVersion, bool verbose,
+		int32_t maxIdleHandlesPerOrigin, bool memoryMappedUpload = false, std::shared_ptr<ApiMetrics> metrics = nullptr,
+		std::shared_ptr<RetryPolicy> retryPolicy = nullptr, std::string http2Origin = "", std::shared_ptr<UploadPacer> uploadPacer = nullptr
+	);
+	~CurlConnectionPool();
+
+	CurlConnectionPool(const CurlConnectionPool &) = delete;
+	CurlConnectionPool &operator=(const CurlConnectionPool &) = delete;
+
+	Lease acquire(const std::string &url);
+
+	// api is the metrics label of the call (see HttpRequest::api)
+	std::string httpGet(
+		const std::string &url, long timeoutInSeconds, const std::string &authorization, const std::vector<std::string> &otherHeaders, int maxRetryNumber,
+		bool outputCompressed, const std::string &api = ""
+	);
+	nlohmann::json httpGetJson(
+		const std::string &url, long timeoutInSeconds, const std::string &authorization, const std::vector<std::string> &otherHeaders, int maxRetryNumber,
+		bool outputCompressed, const std::string &api = ""
+	);
+	// conditional GET (If-None-Match), httpCode is 304 and body is empty in case the resource did not change.
+	// bodyPipe: the 2xx body is handed to its reader while it is received (see HttpRequest::bodyPipe)
+	HttpResponse httpGetIfNoneMatch(
+		const std::string &url, long timeoutInSeconds, const std::string &authorization, const std::vector<std::string> &otherHeaders, int maxRetryNumber,
+		bool outputCompressed, const std::string &eTag, const std::string &api = "", BodyPipe *bodyPipe = nullptr
+	);
+	std::string httpPostString(
+		const std::string &url, long timeoutInSeconds, const std::string &authorization, std::string body, const std::string &contentType,
+		const std::vector<std::string> &otherHeaders, int maxRetryNumber, bool outputCompressed, const std::string &api = ""
+	);
+	nlohmann::json httpPostStringAndGetJson(
+		const std::string &url, long timeoutInSeconds, const std::string &authorization, std::string body, const std::string &contentType,
+		const std::vector<std::string> &otherHeaders, int maxRetryNumber, bool outputCompressed, const std::string &api = ""
+	);
+
+	// the file is sent in chunks (Content-Range) sized by the upload pacer, up to maxChunksInFlight chunks are uploaded at the same time
+	// on different connections and every chunk is retried on its own.
+	// chunkCompleted(chunkIndex, chunksNumber, uploadedBytes) is called in chunk order, once a chunk and all the previous ones are uploaded,
+	// returning true it stops the upload. chunksNumber is an estimate, the chunk size changes during the upload.
+	// The last chunk is sent only when all the previous ones are uploaded.
+	// firstChunkStart > 0 resumes an upload whose previous chunks (firstChunkIndex chunks, firstChunkStart bytes) were already acknowledged
+	std::string httpPostFileSplittingInChunks(
+		const std::string &url, long timeoutInSeconds, const std::string &authorization, const std::string &pathFileName,
+		const std::function<bool(int, int, int64_t)> &chunkCompleted, int maxRetryNumber, int maxChunksInFlight = 1, int firstChunkIndex = 0,
+		int64_t firstChunkStart = 0, const std::string &api = ""
+	);
+	const std::shared_ptr<ApiMetrics> &metrics() const { return _metrics; }
+	const std::shared_ptr<RetryPolicy> &retryPolicy() const { return _retryPolicy; }
+	const std::shared_ptr<UploadPacer> &uploadPacer() const { return _uploadPacer; }
+
+	// set the options of a leased handle for the request, the returned headers list is freed by complete
+	curl_slist *prepare(CURL *handle, const HttpRequest &request, HttpResponse &response) const;
+	// to be called once the transfer of a prepared handle is finished, it throws in case of failure
+	void complete(CURL *handle, CURLcode curlCode, const HttpRequest &request, curl_slist *headersList, HttpResponse &response) const;
+	// false for the failures that a retry will not fix (i.e. 4xx, circuit open)
+	static bool isRetryable(const std::exception_ptr &error);
+
+	// scheme://host:port, it is the key used to group the idle handles
+	static std::string origin(const std::string &url);
+	// gzip format (Content-Encoding: gzip), level 1 (fastest) to 9 (smallest)
+	static std::string compress(const std::string &uncompressed, int level);
+
+  private:
+	std::string _proxyURL;
+	std::string _proxyUsername;
+	std::string _proxyPassword;
+	std::string _sslVersion;
+	bool _verbose;
+	int32_t _maxIdleHandlesPerOrigin;
+	bool _memoryMappedUpload;
+	std::shared_ptr<ApiMetrics> _metrics;
+	std::shared_ptr<RetryPolicy> _retryPolicy;
+	std::string _http2Origin;
+	std::shared_ptr<UploadPacer> _uploadPacer;
+
+	CURLSH *_share;
+	std::mutex _shareMutexes[CURL_LOCK_DATA_LAST];
+
+	std::mutex _idleHandlesMutex;
+	std::unordered_map<std::string, std::vector<CURL *>> _idleHandles;
+
+	struct UploadSource
+	{
+		std::ifstream *fileStream;
+		int64_t remaining;
+	};
+	struct ChunkUpload
+	{
+		int chunkIndex;
+		int retryNumber;
+		int64_t contentRangeStart;
+		int64_t contentRangeEnd_Excluded;
+		std::ifstream fileStream;
+		UploadSource uploadSource;
+		// memory mapped upload, mapping of the chunk (page aligned) while it is being uploaded
+		void *mappedAddress;
+		size_t mappedLength;
+		size_t releasedLength;
+		std::optional<Lease> lease;
+		curl_slist *headersList;
+		std::string response;
+	};
+
+	void release(const std::string &origin, CURL *handle);
+	void setCommonOptions(CURL *handle, const std::string &url, long timeoutInSeconds) const;
+	HttpResponse perform(const HttpRequest &request);
+	void startFileRange(
+		CURLM *multi, ChunkUpload &chunkUpload, const std::string &url, long timeoutInSeconds, const std::string &authorization,
+		const std::string &pathFileName, int64_t fileSize
+	);
+	void mapFileRange(ChunkUpload &chunkUpload, const std::string &pathFileName) const;
+	void stopFileRange(CURLM *multi, ChunkUpload &chunkUpload);
+	// bytes sent/received by the last transfer of handle
+	void recordTransfer(CURL *handle, const std::string &api) const;
+	// throughput and RTT of the last transfer of handle, an uploaded chunk, to the upload pacer
+	void measureChunk(CURL *handle, const ChunkUpload &chunkUpload) const;
+	static long checkResponse(CURL *handle, CURLcode curlCode, const std::string &url, const std::string &response, bool notModifiedAccepted = false);
+	HttpResponse performWithRetries(const HttpRequest &request, int maxRetryNumber);
+
+	static void lockShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr);
+	static void unlockShare(CURL *handle, curl_lock_data data, void *userptr);
+	static size_t readCallback(char *buffer, size_t size, size_t nitems, void *userdata);
+	static int releaseUploadedPagesCallback(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+	static size_t writeCallback(char *ptr, size_t size, size_t nmemb, void *userdata);
+	// appends to the HttpResponse body, inflating the chunks of a compressed body as soon as they are received
+	static size_t responseWriteCallback(char *ptr, size_t size, size_t nmemb, void *userdata);
+	static size_t eTagHeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata);
+};
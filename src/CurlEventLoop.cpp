@@ -0,0 +1,338 @@
+#include "CurlEventLoop.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <format>
+#include <future>
+
+using namespace std;
+
+CurlEventLoop::CurlEventLoop(shared_ptr<CurlConnectionPool> connectionPool) : _connectionPool(std::move(connectionPool)), _stopped(false)
+{
+	_multi = curl_multi_init();
+	if (_multi == nullptr)
+	{
+		string errorMessage = "curl_multi_init failed";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+	// the HTTP/2 transfers to the same host share one connection
+	curl_multi_setopt(_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+	_thread = thread(&CurlEventLoop::run, this);
+}
+
+CurlEventLoop::~CurlEventLoop()
+{
+	_stopped = true;
+	curl_multi_wakeup(_multi);
+	if (_thread.joinable())
+		_thread.join();
+
+	curl_multi_cleanup(_multi);
+}
+
+void CurlEventLoop::submit(
+	CurlConnectionPool::HttpRequest request, int maxRetryNumber, Completion completion, optional<chrono::milliseconds> hedgeDelay
+)
+{
+	auto transfer = make_unique<Transfer>();
+	transfer->request = std::move(request);
+	transfer->maxRetryNumber = maxRetryNumber;
+	transfer->completion = std::move(completion);
+	transfer->hedgeRequest = false;
+	transfer->retryNumber = 0;
+	transfer->headersList = nullptr;
+
+	unique_ptr<Transfer> hedgeTransfer;
+	if (hedgeDelay)
+	{
+		transfer->hedge = make_shared<Hedge>();
+
+		hedgeTransfer = make_unique<Transfer>();
+		hedgeTransfer->request = transfer->request;
+		hedgeTransfer->maxRetryNumber = maxRetryNumber;
+		hedgeTransfer->completion = transfer->completion;
+		hedgeTransfer->hedge = transfer->hedge;
+		hedgeTransfer->hedgeRequest = true;
+		hedgeTransfer->notBefore = chrono::steady_clock::now() + *hedgeDelay;
+		hedgeTransfer->retryNumber = 0;
+		hedgeTransfer->headersList = nullptr;
+	}
+
+	{
+		lock_guard<mutex> locker(_submittedMutex);
+		_submitted.push_back(std::move(transfer));
+		if (hedgeTransfer)
+			_submitted.push_back(std::move(hedgeTransfer));
+	}
+
+	curl_multi_wakeup(_multi);
+}
+
+CurlConnectionPool::HttpResponse
+CurlEventLoop::perform(CurlConnectionPool::HttpRequest request, int maxRetryNumber, optional<chrono::milliseconds> hedgeDelay)
+{
+	auto promise = make_shared<std::promise<CurlConnectionPool::HttpResponse>>();
+	future<CurlConnectionPool::HttpResponse> response = promise->get_future();
+	submit(
+		std::move(request), maxRetryNumber,
+		[promise](CurlConnectionPool::HttpResponse &&response, exception_ptr error)
+		{
+			if (error)
+				promise->set_exception(error);
+			else
+				promise->set_value(std::move(response));
+		},
+		hedgeDelay
+	);
+
+	return response.get();
+}
+
+void CurlEventLoop::run()
+{
+	while (!_stopped)
+	{
+		vector<unique_ptr<Transfer>> submitted;
+		{
+			lock_guard<mutex> locker(_submittedMutex);
+			submitted.swap(_submitted);
+		}
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		for (unique_ptr<Transfer> &transfer : submitted)
+		{
+			// hedge requests wait for their delay as the retries do
+			if (transfer->notBefore > now)
+				_toBeRetried.emplace(transfer->notBefore, std::move(transfer));
+			else
+				start(std::move(transfer));
+		}
+
+		while (!_toBeRetried.empty() && _toBeRetried.begin()->first <= now)
+		{
+			unique_ptr<Transfer> transfer = std::move(_toBeRetried.begin()->second);
+			_toBeRetried.erase(_toBeRetried.begin());
+			start(std::move(transfer));
+		}
+
+		int runningHandles;
+		curl_multi_perform(_multi, &runningHandles);
+
+		CURLMsg *message;
+		int messagesInQueue;
+		while ((message = curl_multi_info_read(_multi, &messagesInQueue)) != nullptr)
+		{
+			if (message->msg == CURLMSG_DONE)
+				finished(message->easy_handle, message->data.result);
+		}
+
+		// wake up in time for the first retry, submit and stop wake up the poll as well
+		int timeoutInMilliSeconds = 1000;
+		if (!_toBeRetried.empty())
+		{
+			auto untilFirstRetry = chrono::duration_cast<chrono::milliseconds>(_toBeRetried.begin()->first - chrono::steady_clock::now()).count();
+			timeoutInMilliSeconds = static_cast<int>(clamp<int64_t>(untilFirstRetry, 0, timeoutInMilliSeconds));
+		}
+		curl_multi_poll(_multi, nullptr, 0, timeoutInMilliSeconds, nullptr);
+	}
+
+	abortAll();
+}
+
+void CurlEventLoop::start(unique_ptr<Transfer> transfer)
+{
+	// the other request of the hedge already won
+	if (transfer->hedge && transfer->hedge->notified)
+		return;
+
+	if (transfer->hedgeRequest && transfer->retryNumber == 0)
+	{
+		if (_connectionPool->metrics())
+			_connectionPool->metrics()->hedged(transfer->request.api);
+		LOG_DEBUG(
+			"HTTP call is slow, hedge request sent"
+			", url: {}",
+			transfer->request.url
+		);
+	}
+
+	try
+	{
+		transfer->response = CurlConnectionPool::HttpResponse();
+		_connectionPool->retryPolicy()->admit(transfer->request.url);
+		transfer->lease.emplace(_connectionPool->acquire(transfer->request.url));
+
+		CURL *handle = transfer->lease->handle();
+		transfer->headersList = _connectionPool->prepare(handle, transfer->request, transfer->response);
+
+		CURLMcode curlMCode = curl_multi_add_handle(_multi, handle);
+		if (curlMCode != CURLM_OK)
+		{
+			string errorMessage = std::format(
+				"curl_multi_add_handle failed"
+				", url: {}"
+				", curlMCode: {}",
+				transfer->request.url, curl_multi_strerror(curlMCode)
+			);
+			SPDLOG_ERROR(errorMessage);
+
+			throw runtime_error(errorMessage);
+		}
+
+		_running[handle] = std::move(transfer);
+	}
+	catch (exception &e)
+	{
+		if (transfer->headersList != nullptr)
+		{
+			curl_slist_free_all(transfer->headersList);
+			transfer->headersList = nullptr;
+		}
+		transfer->lease.reset();
+
+		completed(std::move(transfer), current_exception());
+	}
+}
+
+void CurlEventLoop::finished(CURL *handle, CURLcode curlCode)
+{
+	curl_multi_remove_handle(_multi, handle);
+
+	auto it = _running.find(handle);
+	if (it == _running.end())
+		return;
+	unique_ptr<Transfer> transfer = std::move(it->second);
+	_running.erase(it);
+
+	exception_ptr error;
+	try
+	{
+		_connectionPool->complete(handle, curlCode, transfer->request, transfer->headersList, transfer->response);
+	}
+	catch (exception &e)
+	{
+		error = current_exception();
+	}
+	transfer->headersList = nullptr;
+	// the handle (and its connection) goes back to the pool
+	transfer->lease.reset();
+
+	const shared_ptr<RetryPolicy> &retryPolicy = _connectionPool->retryPolicy();
+	bool retryable = error && CurlConnectionPool::isRetryable(error);
+	if (retryable)
+		retryPolicy->failed(transfer->request.url);
+	else
+		retryPolicy->succeeded(transfer->request.url);
+
+	optional<chrono::milliseconds> retryDelay;
+	if (retryable && transfer->retryNumber < transfer->maxRetryNumber)
+		retryDelay = retryPolicy->retryDelay(transfer->request.url, transfer->retryNumber + 1);
+	if (retryDelay)
+	{
+		transfer->retryNumber++;
+		if (_connectionPool->metrics())
+			_connectionPool->metrics()->retried(transfer->request.api);
+		LOG_WARN(
+			"HTTP call failed, retrying"
+			", url: {}"
+			", retryNumber: {}"
+			", maxRetryNumber: {}"
+			", retryDelay (millisecs): {}",
+			transfer->request.url, transfer->retryNumber, transfer->maxRetryNumber, retryDelay->count()
+		);
+
+		auto retryTime = chrono::steady_clock::now() + *retryDelay;
+		_toBeRetried.emplace(retryTime, std::move(transfer));
+
+		return;
+	}
+
+	completed(std::move(transfer), error);
+}
+
+void CurlEventLoop::completed(unique_ptr<Transfer> transfer, exception_ptr error)
+{
+	if (transfer->hedge)
+	{
+		if (transfer->hedge->notified)
+			return;
+
+		// the other request may still succeed
+		if (error && CurlConnectionPool::isRetryable(error) && --transfer->hedge->pending > 0)
+			return;
+
+		// the other request, if running, is not needed anymore (if scheduled it is discarded by start)
+		for (auto it = _running.begin(); it != _running.end(); ++it)
+		{
+			if (it->second->hedge == transfer->hedge)
+			{
+				cancel(it->first, *it->second);
+				_running.erase(it);
+				break;
+			}
+		}
+	}
+
+	notify(*transfer, error);
+}
+
+void CurlEventLoop::cancel(CURL *handle, Transfer &transfer)
+{
+	curl_multi_remove_handle(_multi, handle);
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, nullptr);
+	curl_slist_free_all(transfer.headersList);
+	transfer.headersList = nullptr;
+	transfer.lease.reset();
+}
+
+void CurlEventLoop::abortAll()
+{
+	exception_ptr error = make_exception_ptr(runtime_error("CurlEventLoop stopped"));
+
+	for (auto &[handle, transfer] : _running)
+	{
+		cancel(handle, *transfer);
+
+		notify(*transfer, error);
+	}
+	_running.clear();
+
+	for (auto &[retryTime, transfer] : _toBeRetried)
+		notify(*transfer, error);
+	_toBeRetried.clear();
+
+	vector<unique_ptr<Transfer>> submitted;
+	{
+		lock_guard<mutex> locker(_submittedMutex);
+		submitted.swap(_submitted);
+	}
+	for (unique_ptr<Transfer> &transfer : submitted)
+		notify(*transfer, error);
+}
+
+void CurlEventLoop::notify(Transfer &transfer, exception_ptr error)
+{
+	// a request and its hedge request have one completion only
+	if (transfer.hedge)
+	{
+		if (transfer.hedge->notified)
+			return;
+		transfer.hedge->notified = true;
+	}
+
+	try
+	{
+		transfer.completion(std::move(transfer.response), error);
+	}
+	catch (exception &e)
+	{
+		SPDLOG_ERROR(
+			"Completion of the transfer failed"
+			", url: {}"
+			", exception: {}",
+			transfer.request.url, e.what()
+		);
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CurlConnectionPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Single thread driving a curl multi handle: all the submitted requests are multiplexed on it,
+// retries included (they are scheduled, nobody sleeps), and the easy handles come from
+// the connection pool, so the connections are reused as in the blocking calls.
+// The HTTP/2 requests (see CurlConnectionPool http2Origin) are multiplexed on one connection per host
+class CurlEventLoop
+{
+  public:
+	// called by the event loop thread once the request is finished (retries included),
+	// error is not null in case of failure
+	using Completion = std::function<void(CurlConnectionPool::HttpResponse &&response, std::exception_ptr error)>;
+
+	explicit CurlEventLoop(std::shared_ptr<CurlConnectionPool> connectionPool);
+	~CurlEventLoop();
+
+	CurlEventLoop(const CurlEventLoop &) = delete;
+	CurlEventLoop &operator=(const CurlEventLoop &) = delete;
+
+	// the retries are decided by the retry policy of the connection pool.
+	// hedgeDelay (idempotent requests only): in case the request is not finished within hedgeDelay, the same request
+	// is sent again and the first response wins (the other request is cancelled). A failed request
+	// waits for the other one, a not retryable failure (i.e. 4xx) is notified immediately
+	void submit(
+		CurlConnectionPool::HttpRequest request, int maxRetryNumber, Completion completion,
+		std::optional<std::chrono::milliseconds> hedgeDelay = std::nullopt
+	);
+	// blocking: submits the request and waits for its completion (not to be called by a Completion)
+	CurlConnectionPool::HttpResponse
+	perform(CurlConnectionPool::HttpRequest request, int maxRetryNumber, std::optional<std::chrono::milliseconds> hedgeDelay = std::nullopt);
+
+  private:
+	// shared by a request and its hedge request
+	struct Hedge
+	{
+		bool notified = false;
+		int pending = 2; // requests not yet failed
+	};
+	struct Transfer
+	{
+		CurlConnectionPool::HttpRequest request;
+		int maxRetryNumber;
+		Completion completion;
+		std::shared_ptr<Hedge> hedge;
+		bool hedgeRequest;
+		std::chrono::steady_clock::time_point notBefore;
+
+		int retryNumber;
+		std::optional<CurlConnectionPool::Lease> lease;
+		curl_slist *headersList;
+		CurlConnectionPool::HttpResponse response;
+	};
+
+	std::shared_ptr<CurlConnectionPool> _connectionPool;
+	CURLM *_multi;
+	std::atomic<bool> _stopped;
+
+	// submitted by the callers and not yet added to the multi handle
+	std::mutex _submittedMutex;
+	std::vector<std::unique_ptr<Transfer>> _submitted;
+
+	// accessed only by the event loop thread
+	std::unordered_map<CURL *, std::unique_ptr<Transfer>> _running;
+	std::multimap<std::chrono::steady_clock::time_point, std::unique_ptr<Transfer>> _toBeRetried;
+
+	std::thread _thread;
+
+	void run();
+	void start(std::unique_ptr<Transfer> transfer);
+	void finished(CURL *handle, CURLcode curlCode);
+	void completed(std::unique_ptr<Transfer> transfer, std::exception_ptr error);
+	void cancel(CURL *handle, Transfer &transfer);
+	void abortAll();
+	static void notify(Transfer &transfer, std::exception_ptr error);
+};
@@ -0,0 +1,244 @@
+#include "EncoderPoolMonitor.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <format>
+#include <unordered_set>
+
+using namespace std;
+
+EncoderPoolMonitor::EncoderPoolMonitor(CatraMMSAPI *api, chrono::seconds refreshInterval)
+	: _api(api), _refreshInterval(refreshInterval), _stopped(false)
+{
+	refresh();
+
+	_thread = thread(&EncoderPoolMonitor::run, this);
+}
+
+EncoderPoolMonitor::~EncoderPoolMonitor() { stop(); }
+
+void EncoderPoolMonitor::stop()
+{
+	{
+		lock_guard<mutex> locker(_stopMutex);
+		_stopped = true;
+	}
+	_stopChanged.notify_all();
+	if (_thread.joinable())
+		_thread.join();
+
+	// the monitor can be kept by the caller after the api is destroyed
+	lock_guard<mutex> locker(_refreshMutex);
+	_api = nullptr;
+}
+
+shared_ptr<const CatraMMSAPI::Encoder> EncoderPoolMonitor::encoder(int64_t encoderKey) const
+{
+	shared_lock<shared_mutex> locker(_snapshotMutex);
+
+	auto it = _encoders.find(encoderKey);
+	if (it == _encoders.end())
+		return nullptr;
+
+	return it->second;
+}
+
+vector<shared_ptr<const CatraMMSAPI::Encoder>> EncoderPoolMonitor::poolEncoders(const string &encodersPoolLabel) const
+{
+	shared_lock<shared_mutex> locker(_snapshotMutex);
+
+	vector<shared_ptr<const CatraMMSAPI::Encoder>> encoders;
+
+	auto it = _pools.find(encodersPoolLabel);
+	if (it == _pools.end())
+		return encoders;
+
+	encoders.reserve(it->second.encoderKeys.size());
+	for (int64_t encoderKey : it->second.encoderKeys)
+		encoders.push_back(_encoders.at(encoderKey));
+
+	return encoders;
+}
+
+shared_ptr<const CatraMMSAPI::Encoder> EncoderPoolMonitor::leastLoadedEncoder() const
+{
+	shared_lock<shared_mutex> locker(_snapshotMutex);
+
+	return leastLoaded(_byCpuUsage);
+}
+
+shared_ptr<const CatraMMSAPI::Encoder> EncoderPoolMonitor::leastLoadedEncoder(const string &encodersPoolLabel) const
+{
+	shared_lock<shared_mutex> locker(_snapshotMutex);
+
+	auto it = _pools.find(encodersPoolLabel);
+	if (it == _pools.end())
+		return nullptr;
+
+	return leastLoaded(it->second.byCpuUsage);
+}
+
+chrono::system_clock::time_point EncoderPoolMonitor::lastRefresh() const
+{
+	shared_lock<shared_mutex> locker(_snapshotMutex);
+
+	return _lastRefresh;
+}
+
+void EncoderPoolMonitor::refresh()
+{
+	lock_guard<mutex> locker(_refreshMutex);
+	if (_api == nullptr)
+	{
+		string errorMessage = "EncoderPoolMonitor stopped, its CatraMMSAPI was destroyed";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	// the cache is bypassed, running and cpuUsage have to be the current ones
+	apply(_api->getEncodersPool(false));
+}
+
+void EncoderPoolMonitor::run()
+{
+	while (true)
+	{
+		{
+			unique_lock<mutex> locker(_stopMutex);
+			if (_stopChanged.wait_for(locker, _refreshInterval, [this]() { return _stopped; }))
+				break;
+		}
+
+		try
+		{
+			refresh();
+		}
+		catch (exception &e)
+		{
+			// the previous snapshot is kept
+			SPDLOG_ERROR(
+				"EncoderPoolMonitor refresh failed"
+				", lastRefresh: {}"
+				", exception: {}",
+				chrono::system_clock::to_time_t(lastRefresh()), e.what()
+			);
+		}
+	}
+}
+
+void EncoderPoolMonitor::apply(const vector<CatraMMSAPI::EncodersPool> &encodersPools)
+{
+	unique_lock<shared_mutex> locker(_snapshotMutex);
+
+	// an encoder may belong to more pools, it is compared once
+	unordered_set<int64_t> fetchedEncoderKeys;
+	unordered_map<int64_t, shared_ptr<const CatraMMSAPI::Encoder>> changedEncoders; // previous version, nullptr if new
+	int64_t updatedEncoders = 0;
+	for (const CatraMMSAPI::EncodersPool &encodersPool : encodersPools)
+	{
+		for (const CatraMMSAPI::Encoder &fetched : encodersPool.encoders)
+		{
+			if (!fetchedEncoderKeys.insert(fetched.encoderKey).second)
+				continue;
+
+			auto it = _encoders.find(fetched.encoderKey);
+			if (it != _encoders.end() && !changed(*it->second, fetched))
+				continue;
+
+			shared_ptr<const CatraMMSAPI::Encoder> previous = it == _encoders.end() ? nullptr : it->second;
+			if (previous && loaded(*previous))
+				_byCpuUsage.erase({previous->cpuUsage, previous->encoderKey});
+			if (loaded(fetched))
+				_byCpuUsage.insert({fetched.cpuUsage, fetched.encoderKey});
+			_encoders[fetched.encoderKey] = make_shared<const CatraMMSAPI::Encoder>(fetched);
+			changedEncoders[fetched.encoderKey] = std::move(previous);
+			updatedEncoders++;
+		}
+	}
+
+	unordered_set<string> fetchedPoolLabels;
+	for (const CatraMMSAPI::EncodersPool &encodersPool : encodersPools)
+	{
+		fetchedPoolLabels.insert(encodersPool.label);
+
+		Pool &pool = _pools[encodersPool.label];
+		pool.encodersPoolKey = encodersPool.encodersPoolKey;
+
+		bool membershipChanged = pool.encoderKeys.size() != encodersPool.encoders.size();
+		for (size_t encoderIndex = 0; !membershipChanged && encoderIndex < encodersPool.encoders.size(); encoderIndex++)
+			membershipChanged = pool.encoderKeys[encoderIndex] != encodersPool.encoders[encoderIndex].encoderKey;
+
+		if (membershipChanged)
+		{
+			pool.encoderKeys.clear();
+			pool.byCpuUsage.clear();
+			for (const CatraMMSAPI::Encoder &fetched : encodersPool.encoders)
+			{
+				pool.encoderKeys.push_back(fetched.encoderKey);
+				if (loaded(fetched))
+					pool.byCpuUsage.insert({fetched.cpuUsage, fetched.encoderKey});
+			}
+
+			continue;
+		}
+
+		for (const CatraMMSAPI::Encoder &fetched : encodersPool.encoders)
+		{
+			auto it = changedEncoders.find(fetched.encoderKey);
+			if (it == changedEncoders.end())
+				continue;
+
+			if (it->second && loaded(*it->second))
+				pool.byCpuUsage.erase({it->second->cpuUsage, it->second->encoderKey});
+			if (loaded(fetched))
+				pool.byCpuUsage.insert({fetched.cpuUsage, fetched.encoderKey});
+		}
+	}
+
+	int64_t removedPools =
+		erase_if(_pools, [&fetchedPoolLabels](const auto &labelAndPool) { return !fetchedPoolLabels.contains(labelAndPool.first); });
+
+	int64_t removedEncoders = 0;
+	for (auto it = _encoders.begin(); it != _encoders.end();)
+	{
+		if (fetchedEncoderKeys.contains(it->first))
+		{
+			++it;
+			continue;
+		}
+
+		if (loaded(*it->second))
+			_byCpuUsage.erase({it->second->cpuUsage, it->first});
+		it = _encoders.erase(it);
+		removedEncoders++;
+	}
+
+	_lastRefresh = chrono::system_clock::now();
+
+	LOG_DEBUG(
+		"EncoderPoolMonitor refreshed"
+		", pools: {}"
+		", encoders: {}"
+		", updatedEncoders: {}"
+		", removedEncoders: {}"
+		", removedPools: {}",
+		_pools.size(), _encoders.size(), updatedEncoders, removedEncoders, removedPools
+	);
+}
+
+bool EncoderPoolMonitor::changed(const CatraMMSAPI::Encoder &current, const CatraMMSAPI::Encoder &fetched)
+{
+	return current.running != fetched.running || current.cpuUsage != fetched.cpuUsage || current.enabled != fetched.enabled ||
+		   current.label != fetched.label || current.external != fetched.external || current.protocol != fetched.protocol ||
+		   current.publicServerName != fetched.publicServerName || current.internalServerName != fetched.internalServerName ||
+		   current.port != fetched.port || current.workspacesAssociatedRoot != fetched.workspacesAssociatedRoot;
+}
+
+shared_ptr<const CatraMMSAPI::Encoder> EncoderPoolMonitor::leastLoaded(const LoadOrder &byCpuUsage) const
+{
+	if (byCpuUsage.empty())
+		return nullptr;
+
+	return _encoders.at(byCpuUsage.begin()->second);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CatraMMSAPI.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// In-memory snapshot of the encoders pools refreshed in background (getEncodersPool): every refresh
+// applies only the changes. Encoders are indexed by encoderKey and by pool, the running and enabled
+// ones are also ordered by cpuUsage, so the least loaded one is found without scanning.
+// Thread safe, the encoders are returned as immutable snapshots
+class EncoderPoolMonitor
+{
+  public:
+	// the first refresh is done by the constructor, it throws in case it fails
+	EncoderPoolMonitor(CatraMMSAPI *api, std::chrono::seconds refreshInterval);
+	~EncoderPoolMonitor();
+
+	EncoderPoolMonitor(const EncoderPoolMonitor &) = delete;
+	EncoderPoolMonitor &operator=(const EncoderPoolMonitor &) = delete;
+
+	std::shared_ptr<const CatraMMSAPI::Encoder> encoder(int64_t encoderKey) const;
+	std::vector<std::shared_ptr<const CatraMMSAPI::Encoder>> poolEncoders(const std::string &encodersPoolLabel) const;
+	// running and enabled encoder with the lowest cpuUsage, nullptr in case there is none
+	std::shared_ptr<const CatraMMSAPI::Encoder> leastLoadedEncoder() const;
+	std::shared_ptr<const CatraMMSAPI::Encoder> leastLoadedEncoder(const std::string &encodersPoolLabel) const;
+
+	// refresh right now, without waiting for the interval
+	void refresh();
+	// stops the background refresh, called by ~CatraMMSAPI: the last snapshot stays readable, refresh() throws
+	void stop();
+	std::chrono::system_clock::time_point lastRefresh() const;
+
+  private:
+	// cpuUsage, encoderKey
+	using LoadOrder = std::set<std::pair<int32_t, int64_t>>;
+
+	struct Pool
+	{
+		int64_t encodersPoolKey;
+		std::vector<int64_t> encoderKeys;
+		LoadOrder byCpuUsage;
+	};
+
+	CatraMMSAPI *_api;
+	std::chrono::seconds _refreshInterval;
+
+	mutable std::shared_mutex _snapshotMutex;
+	std::unordered_map<int64_t, std::shared_ptr<const CatraMMSAPI::Encoder>> _encoders;
+	std::unordered_map<std::string, Pool> _pools; // by label
+	LoadOrder _byCpuUsage;
+	std::chrono::system_clock::time_point _lastRefresh;
+
+	// serializes the refreshes (background and refresh())
+	std::mutex _refreshMutex;
+
+	std::mutex _stopMutex;
+	std::condition_variable _stopChanged;
+	bool _stopped;
+	std::thread _thread;
+
+	void run();
+	void apply(const std::vector<CatraMMSAPI::EncodersPool> &encodersPools);
+	static bool loaded(const CatraMMSAPI::Encoder &encoder) { return encoder.running && encoder.enabled; }
+	static bool changed(const CatraMMSAPI::Encoder &current, const CatraMMSAPI::Encoder &fetched);
+	std::shared_ptr<const CatraMMSAPI::Encoder> leastLoaded(const LoadOrder &byCpuUsage) const;
+};
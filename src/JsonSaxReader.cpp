@@ -0,0 +1,162 @@
+#include "JsonSaxReader.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <format>
+
+using namespace std;
+using json = nlohmann::json;
+
+void JsonSaxReader::parse(const Input &input, Target *root)
+{
+	JsonSaxReader jsonSaxReader(root);
+	// parse_error throws, false is returned only in case the input ended before the end of the json
+	bool parsed = input._stream != nullptr ? json::sax_parse(*input._stream, &jsonSaxReader) : json::sax_parse(*input._text, &jsonSaxReader);
+	if (!parsed)
+	{
+		std::string errorMessage = "json parsing failed, incomplete input";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+}
+
+bool JsonSaxReader::null() { return scalar(nullptr); }
+
+bool JsonSaxReader::boolean(bool val) { return scalar(val); }
+
+bool JsonSaxReader::number_integer(number_integer_t val) { return scalar(val); }
+
+bool JsonSaxReader::number_unsigned(number_unsigned_t val) { return scalar(val); }
+
+bool JsonSaxReader::number_float(number_float_t val, const string_t &s) { return scalar(val); }
+
+bool JsonSaxReader::string(string_t &val) { return scalar(std::move(val)); }
+
+bool JsonSaxReader::binary(binary_t &val) { return scalar(json::binary(std::move(val))); }
+
+bool JsonSaxReader::start_object(size_t elements) { return startContainer(false); }
+
+bool JsonSaxReader::key(string_t &val)
+{
+	if (!_captured.empty())
+		_capturedKey = std::move(val);
+	else if (!_frames.empty())
+		_frames.back().key = std::move(val);
+
+	return true;
+}
+
+bool JsonSaxReader::end_object() { return endContainer(); }
+
+bool JsonSaxReader::start_array(size_t elements) { return startContainer(true); }
+
+bool JsonSaxReader::end_array() { return endContainer(); }
+
+bool JsonSaxReader::parse_error(size_t position, const std::string &last_token, const nlohmann::detail::exception &ex)
+{
+	std::string errorMessage = std::format(
+		"json parsing failed"
+		", position: {}"
+		", last_token: {}"
+		", exception: {}",
+		position, last_token, ex.what()
+	);
+	SPDLOG_ERROR(errorMessage);
+
+	throw runtime_error(errorMessage);
+}
+
+bool JsonSaxReader::scalar(json value)
+{
+	if (!_captured.empty())
+	{
+		addCaptured(std::move(value));
+
+		return true;
+	}
+
+	// a primitive root or the content of a skipped container
+	if (_frames.empty() || _frames.back().target == nullptr)
+		return true;
+
+	Frame &parent = _frames.back();
+	static const std::string arrayElementKey;
+	const std::string &key = parent.array ? arrayElementKey : parent.key;
+	if (json *captured = parent.target->captured(key))
+		*captured = std::move(value);
+	else
+		parent.target->value(key, value);
+
+	return true;
+}
+
+bool JsonSaxReader::startContainer(bool array)
+{
+	json container = array ? json::array() : json::object();
+
+	if (!_captured.empty())
+	{
+		_captured.push_back(&addCaptured(std::move(container)));
+
+		return true;
+	}
+
+	if (_frames.empty())
+	{
+		_frames.push_back({_root, array, ""});
+
+		return true;
+	}
+
+	Target *target = nullptr;
+	if (Target *parentTarget = _frames.back().target; parentTarget != nullptr)
+	{
+		static const std::string arrayElementKey;
+		const std::string &key = _frames.back().array ? arrayElementKey : _frames.back().key;
+		if (json *captured = parentTarget->captured(key))
+		{
+			*captured = std::move(container);
+			_captured.push_back(captured);
+
+			return true;
+		}
+
+		target = parentTarget->nested(key);
+	}
+	_frames.push_back({target, array, ""});
+
+	return true;
+}
+
+bool JsonSaxReader::endContainer()
+{
+	if (!_captured.empty())
+	{
+		_captured.pop_back();
+
+		return true;
+	}
+
+	if (_frames.back().target != nullptr)
+		_frames.back().target->end();
+	_frames.pop_back();
+
+	return true;
+}
+
+json &JsonSaxReader::addCaptured(json value)
+{
+	json &container = *_captured.back();
+	if (container.is_array())
+	{
+		container.push_back(std::move(value));
+
+		return container.back();
+	}
+
+	json &member = container[_capturedKey];
+	member = std::move(value);
+
+	return member;
+}
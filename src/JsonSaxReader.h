@@ -0,0 +1,160 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// SAX handler filling C++ structs straight from the json text: no DOM is built, the events are routed
+// to the Target of the object/array they belong to. Only the values a Target asks to keep as json
+// (captured) are built as DOM, directly in their destination
+class JsonSaxReader : public nlohmann::json_sax<nlohmann::json>
+{
+  public:
+	// receives the content of an object (key is the member name) or of an array (key is empty)
+	class Target
+	{
+	  public:
+		virtual ~Target() = default;
+
+		// primitive value
+		virtual void value(const std::string &key, nlohmann::json &value) {}
+		// object or array value, the returned target receives its content, nullptr to skip it
+		virtual Target *nested(const std::string &key) { return nullptr; }
+		// json where the value (whatever it is) has to be kept as it is, nullptr otherwise
+		virtual nlohmann::json *captured(const std::string &key) { return nullptr; }
+		// end of the object/array
+		virtual void end() {}
+	};
+
+	// object where only the member key is of interest, i.e. {"response": {...}}
+	class MemberTarget : public Target
+	{
+	  public:
+		MemberTarget(std::string key, Target *target) : _key(std::move(key)), _target(target) {}
+
+		Target *nested(const std::string &key) override { return key == _key ? _target : nullptr; }
+
+	  private:
+		std::string _key;
+		Target *_target;
+	};
+
+	// array of T, every element is filled by ElementTarget (it has to provide bind(T *))
+	template <typename T, typename ElementTarget> class ArrayTarget : public Target
+	{
+	  public:
+		template <typename... Args> explicit ArrayTarget(std::vector<T> *elements, Args &&...args) : _elements(elements), _elementTarget(args...) {}
+
+		void bind(std::vector<T> *elements) { _elements = elements; }
+
+		Target *nested(const std::string &key) override
+		{
+			_elements->emplace_back();
+			_elementTarget.bind(&_elements->back());
+
+			return &_elementTarget;
+		}
+
+	  private:
+		std::vector<T> *_elements;
+		ElementTarget _elementTarget;
+	};
+
+	// json text: all of it or a stream of it (i.e. a response body still being received)
+	class Input
+	{
+	  public:
+		Input(const std::string &text) : _text(&text), _stream(nullptr) {}
+		Input(std::istream &stream) : _text(nullptr), _stream(&stream) {}
+
+	  private:
+		friend class JsonSaxReader;
+
+		const std::string *_text;
+		std::istream *_stream;
+	};
+
+	explicit JsonSaxReader(Target *root) : _root(root) {}
+
+	// it throws runtime_error in case input is not a valid json
+	static void parse(const Input &input, Target *root);
+
+	// conversion of a primitive value, defaultValue in case it is null or it cannot be converted
+	template <typename T> static T as(nlohmann::json &value, T defaultValue)
+	{
+		if (value.is_null())
+			return defaultValue;
+
+		if constexpr (std::is_same_v<T, std::string>)
+			return value.is_string() ? std::move(value.get_ref<std::string &>()) : value.dump();
+		else if constexpr (std::is_same_v<T, bool>)
+		{
+			if (value.is_boolean())
+				return value.get<bool>();
+			if (value.is_number())
+				return value.get<int64_t>() != 0;
+			if (value.is_string())
+				return value.get_ref<const std::string &>() == "true";
+
+			return defaultValue;
+		}
+		else
+		{
+			if (value.is_number() || value.is_boolean())
+				return value.get<T>();
+			if (value.is_string())
+			{
+				try
+				{
+					if constexpr (std::is_floating_point_v<T>)
+						return static_cast<T>(std::stod(value.get_ref<const std::string &>()));
+					else
+						return static_cast<T>(std::stoll(value.get_ref<const std::string &>()));
+				}
+				catch (...)
+				{
+				}
+			}
+
+			return defaultValue;
+		}
+	}
+
+	bool null() override;
+	bool boolean(bool val) override;
+	bool number_integer(number_integer_t val) override;
+	bool number_unsigned(number_unsigned_t val) override;
+	bool number_float(number_float_t val, const string_t &s) override;
+	bool string(string_t &val) override;
+	bool binary(binary_t &val) override;
+	bool start_object(std::size_t elements) override;
+	bool key(string_t &val) override;
+	bool end_object() override;
+	bool start_array(std::size_t elements) override;
+	bool end_array() override;
+	bool parse_error(std::size_t position, const std::string &last_token, const nlohmann::detail::exception &ex) override;
+
+  private:
+	struct Frame
+	{
+		Target *target; // nullptr: content skipped
+		bool array;
+		std::string key;
+	};
+
+	Target *_root;
+	std::vector<Frame> _frames;
+
+	// value being captured: containers under construction, from the captured one to the innermost
+	std::vector<nlohmann::json *> _captured;
+	std::string _capturedKey;
+
+	bool scalar(nlohmann::json value);
+	bool startContainer(bool array);
+	bool endContainer();
+	nlohmann::json &addCaptured(nlohmann::json value);
+};
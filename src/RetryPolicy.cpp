@@ -0,0 +1,142 @@
+#include "RetryPolicy.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+using namespace std;
+
+RetryPolicy::RetryPolicy(
+	chrono::milliseconds initialBackoff, chrono::milliseconds maxBackoff, double backoffMultiplier, chrono::seconds budgetWindow, double budgetRatio,
+	int32_t budgetMinRetries, int32_t circuitBreakerFailureThreshold, chrono::seconds circuitBreakerOpenDuration
+)
+	: _initialBackoff(initialBackoff), _maxBackoff(maxBackoff), _backoffMultiplier(backoffMultiplier), _budgetWindow(budgetWindow),
+	  _budgetRatio(budgetRatio), _budgetMinRetries(budgetMinRetries), _circuitBreakerFailureThreshold(circuitBreakerFailureThreshold),
+	  _circuitBreakerOpenDuration(circuitBreakerOpenDuration), _budgetWindowStart(chrono::steady_clock::now()), _budgetWindowCalls(0),
+	  _budgetWindowRetries(0), _random(random_device()())
+{
+}
+
+void RetryPolicy::admit(const string &url)
+{
+	string endpoint = RetryPolicy::endpoint(url);
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+	lock_guard<mutex> locker(_mutex);
+
+	rollBudgetWindow(now);
+	_budgetWindowCalls++;
+
+	auto it = _circuits.find(endpoint);
+	if (it == _circuits.end() || it->second.consecutiveFailures < _circuitBreakerFailureThreshold)
+		return;
+
+	Circuit &circuit = it->second;
+	if (now >= circuit.openUntil)
+	{
+		// probe, the others wait for its outcome (or for another open duration in case it is never reported)
+		circuit.openUntil = now + _circuitBreakerOpenDuration;
+
+		return;
+	}
+
+	string errorMessage = std::format(
+		"Circuit open, call not tried"
+		", endpoint: {}"
+		", consecutiveFailures: {}",
+		endpoint, circuit.consecutiveFailures
+	);
+	LOG_WARN(errorMessage);
+
+	throw CircuitOpenError(errorMessage);
+}
+
+void RetryPolicy::succeeded(const string &url)
+{
+	string endpoint = RetryPolicy::endpoint(url);
+
+	lock_guard<mutex> locker(_mutex);
+
+	auto it = _circuits.find(endpoint);
+	if (it == _circuits.end())
+		return;
+
+	if (it->second.consecutiveFailures >= _circuitBreakerFailureThreshold)
+		LOG_INFO(
+			"Circuit closed"
+			", endpoint: {}",
+			endpoint
+		);
+	_circuits.erase(it);
+}
+
+void RetryPolicy::failed(const string &url)
+{
+	string endpoint = RetryPolicy::endpoint(url);
+
+	lock_guard<mutex> locker(_mutex);
+
+	Circuit &circuit = _circuits[endpoint];
+	circuit.consecutiveFailures++;
+	if (circuit.consecutiveFailures >= _circuitBreakerFailureThreshold)
+	{
+		circuit.openUntil = chrono::steady_clock::now() + _circuitBreakerOpenDuration;
+
+		LOG_WARN(
+			"Circuit open"
+			", endpoint: {}"
+			", consecutiveFailures: {}"
+			", openInSeconds: {}",
+			endpoint, circuit.consecutiveFailures, _circuitBreakerOpenDuration.count()
+		);
+	}
+}
+
+optional<chrono::milliseconds> RetryPolicy::retryDelay(const string &url, int retryNumber)
+{
+	string endpoint = RetryPolicy::endpoint(url);
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+	lock_guard<mutex> locker(_mutex);
+
+	auto it = _circuits.find(endpoint);
+	if (it != _circuits.end() && it->second.consecutiveFailures >= _circuitBreakerFailureThreshold)
+		return nullopt;
+
+	rollBudgetWindow(now);
+	int64_t budget = max<int64_t>(_budgetMinRetries, static_cast<int64_t>(_budgetWindowCalls * _budgetRatio));
+	if (_budgetWindowRetries >= budget)
+	{
+		LOG_WARN(
+			"Retry budget exhausted, call not retried"
+			", endpoint: {}"
+			", budgetWindowCalls: {}"
+			", budgetWindowRetries: {}",
+			endpoint, _budgetWindowCalls, _budgetWindowRetries
+		);
+
+		return nullopt;
+	}
+	_budgetWindowRetries++;
+
+	// half of the backoff is fixed, the other half is random
+	double backoff = _initialBackoff.count() * pow(_backoffMultiplier, max(retryNumber - 1, 0));
+	int64_t backoffInMilliSeconds = static_cast<int64_t>(min(backoff, static_cast<double>(_maxBackoff.count())));
+	uniform_int_distribution<int64_t> jitter(0, backoffInMilliSeconds / 2);
+
+	return chrono::milliseconds(backoffInMilliSeconds - backoffInMilliSeconds / 2 + jitter(_random));
+}
+
+string RetryPolicy::endpoint(const string &url) { return url.substr(0, url.find('?')); }
+
+void RetryPolicy::rollBudgetWindow(chrono::steady_clock::time_point now)
+{
+	if (now - _budgetWindowStart < _budgetWindow)
+		return;
+
+	_budgetWindowStart = now;
+	_budgetWindowCalls = 0;
+	_budgetWindowRetries = 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+// call not even tried because the circuit of its endpoint is open
+class CircuitOpenError : public std::runtime_error
+{
+  public:
+	explicit CircuitOpenError(const std::string &errorMessage) : std::runtime_error(errorMessage) {}
+};
+
+// Retries of the HTTP calls: exponential backoff with jitter, so the clients do not retry all at the same moment,
+// a retry budget (the retries of a time window are limited to a ratio of the calls), so an outage does not
+// multiply the load, and a circuit breaker per endpoint (url without query), failing fast while it is open.
+// Every admitted call has to be followed by succeeded or failed. Thread safe
+class RetryPolicy
+{
+  public:
+	RetryPolicy(
+		std::chrono::milliseconds initialBackoff = std::chrono::milliseconds(200), std::chrono::milliseconds maxBackoff = std::chrono::seconds(10),
+		double backoffMultiplier = 2.0, std::chrono::seconds budgetWindow = std::chrono::seconds(10), double budgetRatio = 0.1,
+		int32_t budgetMinRetries = 10, int32_t circuitBreakerFailureThreshold = 5,
+		std::chrono::seconds circuitBreakerOpenDuration = std::chrono::seconds(30)
+	);
+
+	// throws CircuitOpenError in case the circuit of the endpoint is open. Once the open duration is elapsed
+	// a single call (probe) is admitted, its outcome closes or opens again the circuit
+	void admit(const std::string &url);
+	// the endpoint answered (a 4xx too)
+	void succeeded(const std::string &url);
+	// a failure that a retry could fix (see CurlConnectionPool::isRetryable)
+	void failed(const std::string &url);
+
+	// wait before the retry retryNumber (1 the first), nullopt in case the budget is exhausted or the circuit is open
+	std::optional<std::chrono::milliseconds> retryDelay(const std::string &url, int retryNumber);
+
+	// scheme://host:port/path, the query is not part of the endpoint
+	static std::string endpoint(const std::string &url);
+
+  private:
+	struct Circuit
+	{
+		int32_t consecutiveFailures = 0;
+		std::chrono::steady_clock::time_point openUntil;
+	};
+
+	std::chrono::milliseconds _initialBackoff;
+	std::chrono::milliseconds _maxBackoff;
+	double _backoffMultiplier;
+	std::chrono::seconds _budgetWindow;
+	double _budgetRatio;
+	int32_t _budgetMinRetries;
+	int32_t _circuitBreakerFailureThreshold;
+	std::chrono::seconds _circuitBreakerOpenDuration;
+
+	std::mutex _mutex;
+	std::unordered_map<std::string, Circuit> _circuits;
+	std::chrono::steady_clock::time_point _budgetWindowStart;
+	int64_t _budgetWindowCalls;
+	int64_t _budgetWindowRetries;
+	std::mt19937_64 _random;
+
+	// to be called with _mutex locked
+	void rollBudgetWindow(std::chrono::steady_clock::time_point now);
+};
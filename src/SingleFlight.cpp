@@ -0,0 +1,63 @@
+#include "SingleFlight.h"
+
+#include <future>
+
+using namespace std;
+
+bool SingleFlight::join(const string &key, Waiter waiter)
+{
+	lock_guard<mutex> locker(_mutex);
+
+	auto [it, inserted] = _flights.try_emplace(key);
+	it->second.push_back(std::move(waiter));
+
+	return inserted;
+}
+
+void SingleFlight::completed(const string &key, const shared_ptr<const any> &value, exception_ptr error)
+{
+	vector<Waiter> waiters;
+	{
+		lock_guard<mutex> locker(_mutex);
+
+		auto it = _flights.find(key);
+		if (it == _flights.end())
+			return;
+		waiters = std::move(it->second);
+		_flights.erase(it);
+	}
+
+	// outside the lock, a waiter may start a new call of the same key
+	for (Waiter &waiter : waiters)
+		waiter(value, error);
+}
+
+shared_ptr<const any> SingleFlight::run(const string &key, const function<shared_ptr<const any>()> &call, bool &coalesced)
+{
+	auto promise = make_shared<std::promise<shared_ptr<const any>>>();
+	future<shared_ptr<const any>> result = promise->get_future();
+
+	coalesced = !join(
+		key,
+		[promise](const shared_ptr<const any> &value, exception_ptr error)
+		{
+			if (error)
+				promise->set_exception(error);
+			else
+				promise->set_value(value);
+		}
+	);
+	if (!coalesced)
+	{
+		try
+		{
+			completed(key, call(), nullptr);
+		}
+		catch (...)
+		{
+			completed(key, nullptr, current_exception());
+		}
+	}
+
+	return result.get();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <any>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Coalescing of identical concurrent reads: the first caller of a key does the request, the callers
+// arriving while it is in flight wait for it and receive the same parsed value (or the same error)
+class SingleFlight
+{
+  public:
+	using Waiter = std::function<void(const std::shared_ptr<const std::any> &value, std::exception_ptr error)>;
+
+	// waiter is called once the call of key completes. Returns true in case no call of key is in flight:
+	// the caller has to do it and then call completed (also in case of failure)
+	bool join(const std::string &key, Waiter waiter);
+	// the call of key is no more in flight, all its waiters are called (by the calling thread)
+	void completed(const std::string &key, const std::shared_ptr<const std::any> &value, std::exception_ptr error);
+
+	// blocking variant: call is done only by the first caller, the others wait for its value.
+	// coalesced is set to true in case the value comes from the call of another caller
+	std::shared_ptr<const std::any> run(const std::string &key, const std::function<std::shared_ptr<const std::any>()> &call, bool &coalesced);
+
+  private:
+	std::mutex _mutex;
+	std::unordered_map<std::string, std::vector<Waiter>> _flights;
+};
@@ -0,0 +1,388 @@
+#include "StreamCatalog.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <any>
+#include <format>
+#include <limits>
+
+using namespace std;
+
+StreamCatalog::StreamCatalog(CatraMMSAPI *api, chrono::seconds refreshInterval, int32_t pageSize)
+	: _api(api), _refreshInterval(refreshInterval), _pageSize(pageSize), _stopped(false)
+{
+	sync();
+
+	_thread = thread(&StreamCatalog::run, this);
+}
+
+StreamCatalog::~StreamCatalog() { stop(); }
+
+void StreamCatalog::stop()
+{
+	{
+		lock_guard<mutex> locker(_stopMutex);
+		_stopped = true;
+	}
+	_stopChanged.notify_all();
+	if (_thread.joinable())
+		_thread.join();
+
+	// the catalog can be kept by the caller after the api is destroyed
+	lock_guard<mutex> locker(_syncMutex);
+	_api = nullptr;
+}
+
+shared_ptr<const CatraMMSAPI::Stream> StreamCatalog::stream(int64_t confKey) const
+{
+	shared_lock<shared_mutex> locker(_catalogMutex);
+
+	auto it = _streams.find(confKey);
+	if (it == _streams.end())
+		return nullptr;
+
+	return it->second;
+}
+
+vector<shared_ptr<const CatraMMSAPI::Stream>> StreamCatalog::streams(const Query &query) const
+{
+	shared_lock<shared_mutex> locker(_catalogMutex);
+
+	vector<shared_ptr<const CatraMMSAPI::Stream>> streams;
+
+	// the streams of an ordered label range are already ordered
+	auto fromLabelRange = [&](const string &from, auto inRange)
+	{
+		for (auto it = _byLabel.lower_bound({from, numeric_limits<int64_t>::min()}); it != _byLabel.end() && inRange(it->first); ++it)
+		{
+			const shared_ptr<const CatraMMSAPI::Stream> &stream = _streams.at(it->second);
+			if (matches(*stream, query))
+				streams.push_back(stream);
+		}
+	};
+
+	if (query.label && !query.labelLike)
+	{
+		fromLabelRange(*query.label, [&query](const string &label) { return label == *query.label; });
+
+		return streams;
+	}
+	if (query.labelPrefix)
+	{
+		fromLabelRange(*query.labelPrefix, [&query](const string &label) { return label.starts_with(*query.labelPrefix); });
+
+		return streams;
+	}
+
+	// the smallest candidates set among the facets and the label trigrams
+	const unordered_set<int64_t> *facetCandidates = nullptr;
+	const vector<int64_t> *trigramCandidates = nullptr;
+	size_t candidatesNumber = _streams.size();
+	bool noCandidates = false;
+	auto facet = [&](const Facet &facet, const optional<string> &value)
+	{
+		if (!value)
+			return;
+		auto it = facet.find(*value);
+		if (it == facet.end())
+			noCandidates = true;
+		else if (it->second.size() < candidatesNumber)
+		{
+			facetCandidates = &it->second;
+			trigramCandidates = nullptr;
+			candidatesNumber = it->second.size();
+		}
+	};
+	facet(_byRegion, query.region);
+	facet(_byCountry, query.country);
+	facet(_byType, query.type);
+	facet(_bySourceType, query.sourceType);
+	if (query.label)
+	{
+		for (const string &trigram : trigrams(*query.label))
+		{
+			auto it = _byLabelTrigram.find(trigram);
+			if (it == _byLabelTrigram.end())
+				noCandidates = true;
+			else if (it->second.size() < candidatesNumber)
+			{
+				trigramCandidates = &it->second;
+				facetCandidates = nullptr;
+				candidatesNumber = it->second.size();
+			}
+		}
+	}
+	if (noCandidates)
+		return streams;
+
+	if (facetCandidates == nullptr && trigramCandidates == nullptr)
+	{
+		fromLabelRange("", [](const string &) { return true; });
+
+		return streams;
+	}
+
+	auto candidate = [&](int64_t confKey)
+	{
+		const shared_ptr<const CatraMMSAPI::Stream> &stream = _streams.at(confKey);
+		if (matches(*stream, query))
+			streams.push_back(stream);
+	};
+	if (facetCandidates != nullptr)
+		for_each(facetCandidates->begin(), facetCandidates->end(), candidate);
+	else
+		for_each(trigramCandidates->begin(), trigramCandidates->end(), candidate);
+
+	ranges::sort(
+		streams, [](const shared_ptr<const CatraMMSAPI::Stream> &first, const shared_ptr<const CatraMMSAPI::Stream> &second)
+		{ return tie(first->label, first->confKey) < tie(second->label, second->confKey); }
+	);
+
+	return streams;
+}
+
+size_t StreamCatalog::size() const
+{
+	shared_lock<shared_mutex> locker(_catalogMutex);
+
+	return _streams.size();
+}
+
+chrono::system_clock::time_point StreamCatalog::lastSync() const
+{
+	shared_lock<shared_mutex> locker(_catalogMutex);
+
+	return _lastSync;
+}
+
+void StreamCatalog::sync()
+{
+	string api = "streamCatalog";
+
+	lock_guard<mutex> locker(_syncMutex);
+	if (_api == nullptr)
+	{
+		string errorMessage = "StreamCatalog stopped, its CatraMMSAPI was destroyed";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	ApiMetrics::Call call(_api->_metrics, api);
+
+	shared_ptr<const CatraMMSAPI::Session> session = _api->_session.load();
+	if (!session)
+	{
+		string errorMessage = "login API was not called yet";
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	try
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		unordered_set<int64_t> syncedConfKeys;
+		int64_t notModifiedPages = 0;
+		int64_t changedStreams = 0;
+		size_t pageIndex = 0;
+		for (;; pageIndex++)
+		{
+			string url = _api->streamsURL(
+				*session, static_cast<int32_t>(pageIndex * _pageSize), _pageSize, nullopt, nullopt, nullopt, nullopt, nullopt, nullopt, nullopt,
+				nullopt, nullopt, "asc", false
+			);
+			string eTag = pageIndex < _pages.size() ? _pages[pageIndex].eTag : "";
+
+			any value;
+			CurlConnectionPool::HttpResponse response = _api->streamedGet(*session, api, url, eTag, CatraMMSAPI::parseStreams, value);
+			if (response.httpCode == 304)
+				notModifiedPages++;
+			else
+			{
+				auto [streams, numFound] = any_cast<pair<vector<CatraMMSAPI::Stream>, int64_t>>(std::move(value));
+
+				Page page;
+				page.eTag = response.eTag;
+				for (const CatraMMSAPI::Stream &stream : streams)
+					page.confKeys.push_back(stream.confKey);
+				changedStreams += apply(streams);
+
+				if (pageIndex < _pages.size())
+					_pages[pageIndex] = std::move(page);
+				else
+					_pages.push_back(std::move(page));
+			}
+
+			const Page &page = _pages[pageIndex];
+			syncedConfKeys.insert(page.confKeys.begin(), page.confKeys.end());
+			if (page.confKeys.size() < static_cast<size_t>(_pageSize))
+				break;
+		}
+		_pages.resize(pageIndex + 1);
+
+		int64_t removedStreams = 0;
+		{
+			unique_lock<shared_mutex> catalogLocker(_catalogMutex);
+
+			for (auto it = _streams.begin(); it != _streams.end();)
+			{
+				if (syncedConfKeys.contains(it->first))
+				{
+					++it;
+					continue;
+				}
+
+				unindex(*it->second);
+				it = _streams.erase(it);
+				removedStreams++;
+			}
+
+			_lastSync = chrono::system_clock::now();
+		}
+
+		LOG_INFO(
+			"StreamCatalog synced"
+			", streams: {}"
+			", pages: {}"
+			", notModifiedPages: {}"
+			", changedStreams: {}"
+			", removedStreams: {}"
+			", elapsed (millisecs): {}",
+			syncedConfKeys.size(), _pages.size(), notModifiedPages, changedStreams, removedStreams,
+			chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count()
+		);
+	}
+	catch (exception &e)
+	{
+		string errorMessage = std::format(
+			"{} failed"
+			", exception: {}",
+			api, e.what()
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw;
+	}
+}
+
+void StreamCatalog::run()
+{
+	while (true)
+	{
+		{
+			unique_lock<mutex> locker(_stopMutex);
+			if (_stopChanged.wait_for(locker, _refreshInterval, [this]() { return _stopped; }))
+				break;
+		}
+
+		try
+		{
+			sync();
+		}
+		catch (exception &)
+		{
+			// the catalog is kept as it is, already logged by sync
+		}
+	}
+}
+
+int64_t StreamCatalog::apply(vector<CatraMMSAPI::Stream> &streams)
+{
+	unique_lock<shared_mutex> locker(_catalogMutex);
+
+	int64_t changedStreams = 0;
+	for (CatraMMSAPI::Stream &stream : streams)
+	{
+		auto it = _streams.find(stream.confKey);
+		if (it != _streams.end())
+		{
+			if (*it->second == stream)
+				continue;
+			unindex(*it->second);
+		}
+
+		auto indexed = make_shared<const CatraMMSAPI::Stream>(std::move(stream));
+		index(*indexed);
+		_streams[indexed->confKey] = std::move(indexed);
+		changedStreams++;
+	}
+
+	return changedStreams;
+}
+
+void StreamCatalog::index(const CatraMMSAPI::Stream &stream)
+{
+	_byLabel.insert({stream.label, stream.confKey});
+	for (const string &trigram : trigrams(stream.label))
+		_byLabelTrigram[trigram].push_back(stream.confKey);
+	_byRegion[stream.region].insert(stream.confKey);
+	_byCountry[stream.country].insert(stream.confKey);
+	_byType[stream.type].insert(stream.confKey);
+	_bySourceType[stream.sourceType].insert(stream.confKey);
+}
+
+void StreamCatalog::unindex(const CatraMMSAPI::Stream &stream)
+{
+	_byLabel.erase({stream.label, stream.confKey});
+	for (const string &trigram : trigrams(stream.label))
+	{
+		auto it = _byLabelTrigram.find(trigram);
+		if (it == _byLabelTrigram.end())
+			continue;
+
+		vector<int64_t> &confKeys = it->second;
+		auto confKeyIt = ranges::find(confKeys, stream.confKey);
+		if (confKeyIt != confKeys.end())
+		{
+			*confKeyIt = confKeys.back();
+			confKeys.pop_back();
+		}
+		if (confKeys.empty())
+			_byLabelTrigram.erase(it);
+	}
+	auto unindexFacet = [&stream](Facet &facet, const string &value)
+	{
+		auto it = facet.find(value);
+		if (it == facet.end())
+			return;
+		it->second.erase(stream.confKey);
+		if (it->second.empty())
+			facet.erase(it);
+	};
+	unindexFacet(_byRegion, stream.region);
+	unindexFacet(_byCountry, stream.country);
+	unindexFacet(_byType, stream.type);
+	unindexFacet(_bySourceType, stream.sourceType);
+}
+
+vector<string> StreamCatalog::trigrams(const string &label)
+{
+	vector<string> trigrams;
+	for (size_t index = 0; index + 3 <= label.size(); index++)
+		trigrams.push_back(label.substr(index, 3));
+	ranges::sort(trigrams);
+	trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+	return trigrams;
+}
+
+bool StreamCatalog::matches(const CatraMMSAPI::Stream &stream, const Query &query) const
+{
+	if (query.label && (query.labelLike ? stream.label.find(*query.label) == string::npos : stream.label != *query.label))
+		return false;
+	if (query.labelPrefix && !stream.label.starts_with(*query.labelPrefix))
+		return false;
+	if (query.region && stream.region != *query.region)
+		return false;
+	if (query.country && stream.country != *query.country)
+		return false;
+	if (query.type && stream.type != *query.type)
+		return false;
+	if (query.sourceType && stream.sourceType != *query.sourceType)
+		return false;
+
+	return true;
+}
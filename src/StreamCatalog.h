@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CatraMMSAPI.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Local replica of the streams (getStreams) synced in background page by page: the pages are requested
+// with their ETag, the unchanged ones (304) are not transferred again, and only the changed streams are
+// updated. The streams are indexed by confKey, by label (prefix and substring) and by the region,
+// country, type and sourceType facets, so the queries do not go to the server.
+// Thread safe, the streams are returned as immutable snapshots
+class StreamCatalog
+{
+  public:
+	// the filters are in AND, the labels are matched case sensitive
+	struct Query
+	{
+		// labelLike true: label contained in the stream label, false: same label
+		std::optional<std::string> label;
+		bool labelLike = true;
+		std::optional<std::string> labelPrefix;
+		std::optional<std::string> region;
+		std::optional<std::string> country;
+		std::optional<std::string> type;
+		std::optional<std::string> sourceType;
+	};
+
+	// the first sync is done by the constructor, it throws in case it fails
+	StreamCatalog(CatraMMSAPI *api, std::chrono::seconds refreshInterval, int32_t pageSize);
+	~StreamCatalog();
+
+	StreamCatalog(const StreamCatalog &) = delete;
+	StreamCatalog &operator=(const StreamCatalog &) = delete;
+
+	std::shared_ptr<const CatraMMSAPI::Stream> stream(int64_t confKey) const;
+	// matching streams ordered by label
+	std::vector<std::shared_ptr<const CatraMMSAPI::Stream>> streams(const Query &query) const;
+	size_t size() const;
+
+	// sync right now, without waiting for the interval
+	void sync();
+	// stops the background sync, called by ~CatraMMSAPI: the streams stay readable, sync() throws
+	void stop();
+	std::chrono::system_clock::time_point lastSync() const;
+
+  private:
+	using Facet = std::unordered_map<std::string, std::unordered_set<int64_t>>;
+
+	struct Page
+	{
+		std::string eTag;
+		std::vector<int64_t> confKeys;
+	};
+
+	CatraMMSAPI *_api;
+	std::chrono::seconds _refreshInterval;
+	int32_t _pageSize;
+
+	mutable std::shared_mutex _catalogMutex;
+	std::unordered_map<int64_t, std::shared_ptr<const CatraMMSAPI::Stream>> _streams;
+	// label, confKey
+	std::set<std::pair<std::string, int64_t>> _byLabel;
+	// label trigrams, a substring is looked for only among the streams having its rarest trigram
+	std::unordered_map<std::string, std::vector<int64_t>> _byLabelTrigram;
+	Facet _byRegion;
+	Facet _byCountry;
+	Facet _byType;
+	Facet _bySourceType;
+	std::chrono::system_clock::time_point _lastSync;
+
+	// used only by the syncs, serialized by _syncMutex
+	std::mutex _syncMutex;
+	std::vector<Page> _pages;
+
+	std::mutex _stopMutex;
+	std::condition_variable _stopChanged;
+	bool _stopped;
+	std::thread _thread;
+
+	void run();
+	// returns the number of added or changed streams
+	int64_t apply(std::vector<CatraMMSAPI::Stream> &streams);
+	void index(const CatraMMSAPI::Stream &stream);
+	void unindex(const CatraMMSAPI::Stream &stream);
+	static std::vector<std::string> trigrams(const std::string &label);
+	bool matches(const CatraMMSAPI::Stream &stream, const Query &query) const;
+};
@@ -0,0 +1,77 @@
+#include "UploadBandwidthCap.h"
+
+#include <algorithm>
+
+using namespace std;
+
+shared_ptr<UploadBandwidthCap> UploadBandwidthCap::process()
+{
+	static shared_ptr<UploadBandwidthCap> bandwidthCap = make_shared<UploadBandwidthCap>();
+
+	return bandwidthCap;
+}
+
+void UploadBandwidthCap::addCap(int64_t maxBytesPerSecond)
+{
+	if (maxBytesPerSecond <= 0)
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	_caps.insert(maxBytesPerSecond);
+	shareChanged();
+}
+
+void UploadBandwidthCap::removeCap(int64_t maxBytesPerSecond)
+{
+	if (maxBytesPerSecond <= 0)
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	auto it = _caps.find(maxBytesPerSecond);
+	if (it != _caps.end())
+		_caps.erase(it);
+	shareChanged();
+}
+
+void UploadBandwidthCap::chunkStarted(CURLM *multi)
+{
+	lock_guard<mutex> locker(_mutex);
+
+	_chunksInFlight++;
+	_multis[multi]++;
+	if (!_caps.empty())
+		shareChanged();
+}
+
+void UploadBandwidthCap::chunkStopped(CURLM *multi)
+{
+	lock_guard<mutex> locker(_mutex);
+
+	_chunksInFlight--;
+	// the multi is not woken up anymore once it has no chunks in flight: it can be cleaned up
+	auto it = _multis.find(multi);
+	if (it != _multis.end() && --it->second <= 0)
+		_multis.erase(it);
+	if (!_caps.empty())
+		shareChanged();
+}
+
+int64_t UploadBandwidthCap::sendSpeed()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	if (_caps.empty())
+		return 0;
+
+	// at least 1: 0 would mean no limit to libcurl
+	return max<int64_t>(*_caps.begin() / max(_chunksInFlight, 1), 1);
+}
+
+// called with _mutex locked: the multis registered are not cleaned up meanwhile
+void UploadBandwidthCap::shareChanged()
+{
+	for (auto &[multi, chunksInFlight] : _multis)
+		curl_multi_wakeup(multi);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <curl/curl.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+// Bandwidth cap of the chunked uploads of the whole process (all the CatraMMSAPI instances): the cap is
+// split among the chunks in flight of all the uploads and every upload is woken up to apply its new share
+// once a chunk is started or stopped. In case more instances configure a cap, the lowest one applies. Thread safe
+class UploadBandwidthCap
+{
+  public:
+	// the one of the process
+	static std::shared_ptr<UploadBandwidthCap> process();
+
+	// maxBytesPerSecond 0: no cap from this caller
+	void addCap(int64_t maxBytesPerSecond);
+	void removeCap(int64_t maxBytesPerSecond);
+
+	// multi (the curl multi of an upload) is woken up, by curl_multi_wakeup, every time the share changes
+	// while it has chunks in flight
+	void chunkStarted(CURLM *multi);
+	void chunkStopped(CURLM *multi);
+	// bytes per second each chunk in flight can send, 0 in case there is no cap
+	int64_t sendSpeed();
+
+  private:
+	std::mutex _mutex;
+	std::multiset<int64_t> _caps;
+	int _chunksInFlight = 0;
+	// chunks in flight by multi
+	std::unordered_map<CURLM *, int> _multis;
+
+	void shareChanged();
+};
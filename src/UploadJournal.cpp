@@ -0,0 +1,148 @@
+#include "UploadJournal.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+using namespace std;
+using json = nlohmann::json;
+
+UploadJournal::UploadJournal(const string &journalDirectory, int64_t ingestionJobKey, string pathFileName)
+	: _ingestionJobKey(ingestionJobKey), _pathFileName(std::move(pathFileName)), _chunksAcknowledged(0), _bytesAcknowledged(0)
+{
+	_journalPathFileName = (filesystem::path(journalDirectory) / std::format("{}.upload.json", ingestionJobKey)).string();
+	_fileIdentityRoot = fileIdentity();
+
+	load();
+}
+
+json UploadJournal::fileIdentity() const
+{
+	struct stat fileStat;
+	if (stat(_pathFileName.c_str(), &fileStat) != 0)
+	{
+		string errorMessage = std::format(
+			"stat failed"
+			", pathFileName: {}",
+			_pathFileName
+		);
+		SPDLOG_ERROR(errorMessage);
+
+		throw runtime_error(errorMessage);
+	}
+
+	json fileIdentityRoot;
+	fileIdentityRoot["pathFileName"] = filesystem::absolute(_pathFileName).string();
+	fileIdentityRoot["device"] = static_cast<uint64_t>(fileStat.st_dev);
+	fileIdentityRoot["inode"] = static_cast<uint64_t>(fileStat.st_ino);
+	fileIdentityRoot["size"] = static_cast<int64_t>(fileStat.st_size);
+	fileIdentityRoot["modificationTime"] = static_cast<int64_t>(fileStat.st_mtime);
+
+	return fileIdentityRoot;
+}
+
+void UploadJournal::load()
+{
+	if (!filesystem::exists(_journalPathFileName))
+		return;
+
+	try
+	{
+		ifstream journalStream(_journalPathFileName);
+		stringstream buffer;
+		buffer << journalStream.rdbuf();
+		json journalRoot = JSONUtils::toJson<json>(buffer.str());
+
+		if (journalRoot.value("ingestionJobKey", static_cast<int64_t>(-1)) != _ingestionJobKey ||
+			journalRoot.value("file", json()) != _fileIdentityRoot)
+		{
+			LOG_WARN(
+				"Upload journal refers to a different file, upload starts from the beginning"
+				", journalPathFileName: {}"
+				", pathFileName: {}",
+				_journalPathFileName, _pathFileName
+			);
+
+			return;
+		}
+
+		_chunksAcknowledged = journalRoot.value("chunksAcknowledged", 0);
+		// journals written when the chunk size was fixed have chunkSize instead of bytesAcknowledged
+		if (journalRoot.contains("bytesAcknowledged"))
+			_bytesAcknowledged = journalRoot.value("bytesAcknowledged", static_cast<int64_t>(0));
+		else
+			_bytesAcknowledged = _chunksAcknowledged * journalRoot.value("chunkSize", static_cast<int64_t>(0));
+		if (_bytesAcknowledged <= 0 || _bytesAcknowledged > _fileIdentityRoot["size"].get<int64_t>())
+		{
+			_chunksAcknowledged = 0;
+			_bytesAcknowledged = 0;
+
+			return;
+		}
+
+		LOG_INFO(
+			"Upload resumed"
+			", ingestionJobKey: {}"
+			", pathFileName: {}"
+			", chunksAcknowledged: {}"
+			", bytesAcknowledged: {}",
+			_ingestionJobKey, _pathFileName, _chunksAcknowledged, _bytesAcknowledged
+		);
+	}
+	catch (exception &e)
+	{
+		// a broken journal just means the upload starts from the beginning
+		LOG_WARN(
+			"Upload journal not valid, ignored"
+			", journalPathFileName: {}"
+			", exception: {}",
+			_journalPathFileName, e.what()
+		);
+	}
+}
+
+void UploadJournal::acknowledged(int chunksAcknowledged, int64_t bytesAcknowledged)
+{
+	_chunksAcknowledged = chunksAcknowledged;
+	_bytesAcknowledged = bytesAcknowledged;
+
+	save();
+}
+
+void UploadJournal::save() const
+{
+	json journalRoot;
+	journalRoot["ingestionJobKey"] = _ingestionJobKey;
+	journalRoot["file"] = _fileIdentityRoot;
+	journalRoot["chunksAcknowledged"] = _chunksAcknowledged;
+	journalRoot["bytesAcknowledged"] = _bytesAcknowledged;
+
+	// written on a temporary file and renamed, a crash never leaves a truncated journal
+	string temporaryPathFileName = _journalPathFileName + ".tmp";
+	{
+		ofstream journalStream(temporaryPathFileName, ios::trunc);
+		journalStream << JSONUtils::toString(journalRoot);
+		if (!journalStream)
+		{
+			string errorMessage = std::format(
+				"Failed to write the upload journal"
+				", journalPathFileName: {}",
+				temporaryPathFileName
+			);
+			SPDLOG_ERROR(errorMessage);
+
+			throw runtime_error(errorMessage);
+		}
+	}
+	filesystem::rename(temporaryPathFileName, _journalPathFileName);
+}
+
+void UploadJournal::remove()
+{
+	error_code errorCode;
+	filesystem::remove(_journalPathFileName, errorCode);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <string>
+
+// On-disk journal of a chunked upload (ingestionBinary). It records how many chunks and bytes, in order, were acknowledged
+// by the binary host, so that a new process uploading the same file for the same ingestion job resumes
+// from the first byte not acknowledged instead of sending again the file from the beginning.
+// The journal is discarded in case the file changed (size, modification time, inode)
+class UploadJournal
+{
+  public:
+	UploadJournal(const std::string &journalDirectory, int64_t ingestionJobKey, std::string pathFileName);
+
+	// index of the first chunk to be sent, 0 in case there is nothing to resume
+	int firstChunkToBeSent() const { return _chunksAcknowledged; }
+	// offset of the first byte to be sent, 0 in case there is nothing to resume
+	int64_t firstByteToBeSent() const { return _bytesAcknowledged; }
+	// chunks from 0 to chunksAcknowledged - 1, bytes from 0 to bytesAcknowledged - 1, were acknowledged
+	void acknowledged(int chunksAcknowledged, int64_t bytesAcknowledged);
+	// upload completed, nothing to resume anymore
+	void remove();
+
+  private:
+	std::string _journalPathFileName;
+	int64_t _ingestionJobKey;
+	std::string _pathFileName;
+	nlohmann::json _fileIdentityRoot;
+	int _chunksAcknowledged;
+	int64_t _bytesAcknowledged;
+
+	nlohmann::json fileIdentity() const;
+	void load();
+	void save() const;
+};
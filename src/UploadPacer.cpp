@@ -0,0 +1,60 @@
+#include "UploadPacer.h"
+#include "JSONUtils.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+UploadPacer::UploadPacer(
+	int64_t initialChunkSize, int64_t minChunkSize, int64_t maxChunkSize, chrono::seconds targetChunkDuration, int64_t maxBytesPerSecond
+)
+	: _minChunkSize(max<int64_t>(minChunkSize, 1)), _maxChunkSize(max(maxChunkSize, _minChunkSize)), _targetChunkDuration(targetChunkDuration),
+	  _maxBytesPerSecond(maxBytesPerSecond), _bandwidthCap(UploadBandwidthCap::process()),
+	  _chunkSize(clamp(initialChunkSize, _minChunkSize, _maxChunkSize)), _bytesPerSecond(0), _rtt(0)
+{
+	_bandwidthCap->addCap(_maxBytesPerSecond);
+}
+
+UploadPacer::~UploadPacer() { _bandwidthCap->removeCap(_maxBytesPerSecond); }
+
+int64_t UploadPacer::chunkSize()
+{
+	lock_guard<mutex> locker(_mutex);
+
+	return _chunkSize;
+}
+
+void UploadPacer::measured(int64_t chunkLength, chrono::microseconds transferTime, chrono::microseconds connectTime)
+{
+	if (chunkLength <= 0 || transferTime.count() <= 0)
+		return;
+
+	lock_guard<mutex> locker(_mutex);
+
+	// smoothed as TCP does (1/8 of the new sample)
+	if (connectTime.count() > 0)
+		_rtt = _rtt.count() == 0 ? connectTime : (_rtt * 7 + connectTime) / 8;
+
+	// the request headers and the response take about one RTT more than the chunk data
+	double dataSeconds = chrono::duration<double>(max(transferTime - _rtt, transferTime / 2)).count();
+	double bytesPerSecond = chunkLength / dataSeconds;
+	_bytesPerSecond = _bytesPerSecond == 0 ? bytesPerSecond : _bytesPerSecond * 0.7 + bytesPerSecond * 0.3;
+
+	chrono::microseconds targetDuration = _targetChunkDuration;
+	double targetDataSeconds = chrono::duration<double>(max(targetDuration - _rtt, targetDuration / 2)).count();
+	int64_t chunkSize = clamp<int64_t>(llround(_bytesPerSecond * targetDataSeconds), _minChunkSize, _maxChunkSize);
+	if (chunkSize != _chunkSize)
+	{
+		LOG_DEBUG(
+			"Upload chunk size tuned"
+			", bytesPerSecond: {}"
+			", rtt (microsecs): {}"
+			", previousChunkSize: {}"
+			", chunkSize: {}",
+			llround(_bytesPerSecond), _rtt.count(), _chunkSize, chunkSize
+		);
+		_chunkSize = chunkSize;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "UploadBandwidthCap.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Chunk size of the chunked uploads (ingestionBinary) of a CatraMMSAPI instance.
+// The chunk size follows the throughput and the RTT measured on the previous chunks: every chunk is sized
+// to last about targetChunkDuration, so the chunks grow on fast links and do not time out on slow ones.
+// The bandwidth cap (maxBytesPerSecond) is added to the one of the process (see UploadBandwidthCap) while
+// this object exists, every chunk is sent at its share of the cap (CURLOPT_MAX_SEND_SPEED_LARGE). Thread safe
+class UploadPacer
+{
+  public:
+	// minChunkSize == maxChunkSize: fixed chunk size. maxBytesPerSecond 0: no bandwidth cap
+	UploadPacer(
+		int64_t initialChunkSize = 100 * 1000 * 1000, int64_t minChunkSize = 5 * 1000 * 1000, int64_t maxChunkSize = 1000 * 1000 * 1000,
+		std::chrono::seconds targetChunkDuration = std::chrono::seconds(30), int64_t maxBytesPerSecond = 0
+	);
+	~UploadPacer();
+
+	UploadPacer(const UploadPacer &) = delete;
+	UploadPacer &operator=(const UploadPacer &) = delete;
+
+	// size of the next chunk to be sent
+	int64_t chunkSize();
+	// a chunk of chunkLength bytes was uploaded in transferTime (slowed down by the bandwidth cap, if any).
+	// connectTime: TCP handshake (one RTT) in case a new connection was opened, zero otherwise
+	void measured(int64_t chunkLength, std::chrono::microseconds transferTime, std::chrono::microseconds connectTime);
+
+	// the cap of the process, also in case this object has no cap
+	const std::shared_ptr<UploadBandwidthCap> &bandwidthCap() const { return _bandwidthCap; }
+
+  private:
+	int64_t _minChunkSize;
+	int64_t _maxChunkSize;
+	std::chrono::seconds _targetChunkDuration;
+	int64_t _maxBytesPerSecond;
+	std::shared_ptr<UploadBandwidthCap> _bandwidthCap;
+
+	std::mutex _mutex;
+	int64_t _chunkSize;
+	// moving averages, zero until the first measure
+	double _bytesPerSecond;
+	std::chrono::microseconds _rtt;
+};
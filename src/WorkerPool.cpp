@@ -0,0 +1,67 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+WorkerPool::WorkerPool(int32_t threadsNumber) : _idleThreads(0), _stopped(false)
+{
+	threadsNumber = max(threadsNumber, 1);
+	_threads.reserve(threadsNumber);
+	for (int32_t threadIndex = 0; threadIndex < threadsNumber; threadIndex++)
+		_threads.emplace_back(&WorkerPool::run, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		lock_guard<mutex> locker(_mutex);
+		_stopped = true;
+	}
+	_tasksChanged.notify_all();
+	for (thread &workerThread : _threads)
+		workerThread.join();
+}
+
+void WorkerPool::post(function<void()> task)
+{
+	{
+		lock_guard<mutex> locker(_mutex);
+		_tasks.push_back(std::move(task));
+	}
+	_tasksChanged.notify_one();
+}
+
+bool WorkerPool::tryPost(function<void()> task)
+{
+	{
+		lock_guard<mutex> locker(_mutex);
+		// the idle threads are going to run the tasks already queued first
+		if (_idleThreads <= static_cast<int32_t>(_tasks.size()))
+			return false;
+		_tasks.push_back(std::move(task));
+	}
+	_tasksChanged.notify_one();
+
+	return true;
+}
+
+void WorkerPool::run()
+{
+	while (true)
+	{
+		function<void()> task;
+		{
+			unique_lock<mutex> locker(_mutex);
+			_idleThreads++;
+			_tasksChanged.wait(locker, [this]() { return _stopped || !_tasks.empty(); });
+			_idleThreads--;
+			if (_tasks.empty())
+				return;
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed number of threads running the posted tasks in order. It keeps the CPU work (parsing of the
+// responses, save of the catalog snapshot) off the event loop thread, and gives the streamed parses
+// their reader thread without starting one for every call. Thread safe
+class WorkerPool
+{
+  public:
+	explicit WorkerPool(int32_t threadsNumber);
+	// the tasks already posted are run before the threads are stopped
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	// the task has to catch its exceptions
+	void post(std::function<void()> task);
+	// the task is posted only in case a thread is idle and starts it right now, false otherwise
+	bool tryPost(std::function<void()> task);
+
+  private:
+	std::mutex _mutex;
+	std::condition_variable _tasksChanged;
+	std::deque<std::function<void()>> _tasks;
+	int32_t _idleThreads;
+	bool _stopped;
+	std::vector<std::thread> _threads;
+
+	void run();
+};